@@ -0,0 +1,42 @@
+#include "alias_table.hpp"
+
+using namespace std;
+
+bool buildAliasTable(AliasTable &table, const vector<double> &weights)
+{
+    size_t n = weights.size();
+    double total = 0.0;
+    for (double weight : weights)
+        total += weight > 0.0 ? weight : 0.0;
+    if (n == 0 || total <= 0.0)
+        return false;
+
+    // scale so the average column holds exactly 1, then pair every short column with a tall one
+    vector<double> scaled(n);
+    vector<int> small, large;
+    for (size_t i = 0; i < n; i++)
+    {
+        scaled[i] = (weights[i] > 0.0 ? weights[i] : 0.0) * (double)n / total;
+        (scaled[i] < 1.0 ? small : large).push_back((int)i);
+    }
+
+    table.probability.assign(n, 1.f);
+    table.alias.resize(n);
+    for (size_t i = 0; i < n; i++)
+        table.alias[i] = (int)i;
+
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        int l = large.back();
+        small.pop_back();
+        large.pop_back();
+
+        table.probability[static_cast<size_t>(s)] = (float)scaled[static_cast<size_t>(s)];
+        table.alias[static_cast<size_t>(s)] = l;
+        scaled[static_cast<size_t>(l)] -= 1.0 - scaled[static_cast<size_t>(s)];
+        (scaled[static_cast<size_t>(l)] < 1.0 ? small : large).push_back(l);
+    }
+    // whatever is left is 1 up to rounding error, probability is already 1 there
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "random.hpp"
+
+/**
+ * Walker/Vose alias table: any discrete distribution over n outcomes sampled in O(1),
+ * one column pick and one biased coin per sample, no rejection.
+ */
+struct AliasTable
+{
+    std::vector<float> probability; // chance of keeping the picked column instead of its alias
+    std::vector<int> alias;
+};
+
+bool buildAliasTable(AliasTable &table, const std::vector<double> &weights); // false if no weight is positive
+
+// One sample from 64 random bits: the high half picks the column, 24 low bits flip the coin
+inline int sampleAlias(const AliasTable &table, uint64_t bits)
+{
+    uint32_t n = static_cast<uint32_t>(table.alias.size());
+    int column = static_cast<int>(((bits >> 32) * n) >> 32); // unbiased enough for n << 2^32
+    float coin = static_cast<float>(bits & 0xFFFFFFu) * (1.f / 16777216.f);
+    return coin < table.probability[static_cast<size_t>(column)] ? column : table.alias[static_cast<size_t>(column)];
+}
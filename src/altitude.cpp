@@ -0,0 +1,76 @@
+#include "altitude.hpp"
+
+#include <algorithm>
+
+#include "altitude_kernels.hpp"
+
+using namespace std;
+
+static void fillWave(vector<float> &wave, int size, int first, float phase)
+{
+    wave.resize(static_cast<size_t>(size));
+    altitudeKernels().wave(wave.data(), size, (float)first, phase);
+}
+
+static void waveRange(const vector<float> &wave, float &lo, float &hi)
+{
+    auto range = minmax_element(wave.begin(), wave.end());
+    lo = wave.empty() ? 0.f : *range.first;
+    hi = wave.empty() ? 0.f : *range.second;
+}
+
+void updateAltitudeField(AltitudeField &field, int size, float time, float speed, float amplitude, unsigned short option, int colOrigin, int rowOrigin)
+{
+    field.size = size;
+    field.amplitude = amplitude;
+    field.option = option;
+
+    float phase = time * speed;
+    if (option != 2)
+        fillWave(field.rowWave, size, rowOrigin, phase);
+    if (option != 1)
+        fillWave(field.colWave, size, colOrigin, phase);
+
+    float rowLo = 1.f, rowHi = 1.f, colLo = 1.f, colHi = 1.f; // a wave the option does not use counts as 1
+    if (option != 2)
+        waveRange(field.rowWave, rowLo, rowHi);
+    if (option != 1)
+        waveRange(field.colWave, colLo, colHi);
+    float corners[4] = {rowLo * colLo, rowLo * colHi, rowHi * colLo, rowHi * colHi}; // extremes of the product
+    field.minAltitude = *min_element(corners, corners + 4) * amplitude;
+    field.maxAltitude = *max_element(corners, corners + 4) * amplitude + (field.base.data ? field.maxBase : 0.f);
+}
+
+void setAltitudeBase(AltitudeField &field, TileSpan<const uint16_t> base, float maxBase)
+{
+    field.base = base;
+    field.maxBase = maxBase;
+}
+
+void altitudeRow(const AltitudeField &field, int row, int colBegin, int count, float *out)
+{
+    const AltitudeKernels &kernels = altitudeKernels();
+    switch (field.option)
+    {
+    case 1:
+        kernels.fill(out, count, field.rowWave[static_cast<size_t>(row)] * field.amplitude); // along row
+        break;
+    case 2:
+        kernels.scale(out, field.colWave.data() + colBegin, count, field.amplitude); // along col
+        break;
+    case 3:
+    default:
+        kernels.scale(out, field.colWave.data() + colBegin, count, field.rowWave[static_cast<size_t>(row)] * field.amplitude); // along both
+    }
+    if (!field.base.data)
+        return;
+    // the heights of a row are contiguous within a chunk
+    const int mask = TILE_CHUNK_SIZE - 1;
+    for (int col = colBegin; col < colBegin + count;)
+    {
+        const uint16_t *heights = field.base.chunk(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT) + ((row & mask) << TILE_CHUNK_SHIFT);
+        int end = min(colBegin + count, (col | mask) + 1);
+        for (; col < end; col++)
+            out[col - colBegin] += (float)heights[col & mask];
+    }
+}
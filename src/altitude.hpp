@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "tile_map.hpp"
+
+/**
+ * Altitude of every tile for the current frame. All oscillation options are separable,
+ * sin(row + t) and sin(col + t) only depend on one index, so one value per row and one
+ * per column is enough; a tile's altitude is a lookup (options 1, 2) or an outer product (option 3),
+ * plus the tile's base height when the map carries them.
+ */
+struct AltitudeField
+{
+    std::vector<float> rowWave; // sin(row + t * speed), filled when the option needs it
+    std::vector<float> colWave; // sin(col + t * speed)
+    float amplitude;
+    unsigned short option;
+    int size;
+    TileSpan<const uint16_t> base = {nullptr, 0}; // base heights of the tile map added to the waves, data null for none
+    float maxBase = 0.f;                           // bound on the base heights
+    float minAltitude;                             // bounds of every altitude in the field, for picking
+    float maxAltitude;
+};
+
+// Base heights added to every altitude from the next updateAltitudeField(), indexed like the field (no origin)
+void setAltitudeBase(AltitudeField &field, TileSpan<const uint16_t> base, float maxBase);
+
+void updateAltitudeField(AltitudeField &field, int size, float time, float speed, float amplitude, unsigned short option,
+                         int colOrigin = 0, int rowOrigin = 0); // once per frame, index 0 is tile (colOrigin, rowOrigin)
+void altitudeRow(const AltitudeField &field, int row, int colBegin, int count, float *out);                              // altitudes of `count` tiles of a row
+
+inline float altitudeAt(const AltitudeField &field, int row, int col)
+{
+    float base = field.base.data ? (float)field.base(col, row) : 0.f;
+    switch (field.option)
+    {
+    case 1:
+        return base + field.rowWave[static_cast<size_t>(row)] * field.amplitude; // along row
+    case 2:
+        return base + field.colWave[static_cast<size_t>(col)] * field.amplitude; // along col
+    case 3:
+    default:
+        return base + field.rowWave[static_cast<size_t>(row)] * field.colWave[static_cast<size_t>(col)] * field.amplitude; // along both
+    }
+}
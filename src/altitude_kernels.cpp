@@ -0,0 +1,210 @@
+#include "altitude_kernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ALTITUDE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// 2 * pi split in three parts (Cody-Waite), k * TWO_PI_A is exact for any k the grid can produce
+#define TWO_PI_A 6.28125f
+#define TWO_PI_B 1.935307169e-03f
+#define TWO_PI_C 1.025313168e-11f
+#define INV_TWO_PI 0.159154937f
+#define PI_F 3.14159274f
+
+// Minimax coefficients of sin on [-pi/2, pi/2]
+#define SIN_C1 0.99999999997884898600f
+#define SIN_C3 -0.16666666608826069641f
+#define SIN_C5 0.00833333072055773645f
+#define SIN_C7 -0.00019840832823261955f
+#define SIN_C9 2.75239710746326498e-6f
+
+static inline float sinScalar(float x)
+{
+    float k = __builtin_roundf(x * INV_TWO_PI);
+    float r = ((x - k * TWO_PI_A) - k * TWO_PI_B) - k * TWO_PI_C; // r in [-pi, pi]
+    float a = r < 0.f ? -r : r;
+    a = a < PI_F - a ? a : PI_F - a; // sin(a) == sin(pi - a), fold into [0, pi/2]
+    float a2 = a * a;
+    float p = ((((SIN_C9 * a2 + SIN_C7) * a2 + SIN_C5) * a2 + SIN_C3) * a2 + SIN_C1) * a;
+    return r < 0.f ? -p : p;
+}
+
+static void waveScalar(float *out, int count, float first, float phase)
+{
+    for (int i = 0; i < count; i++)
+        out[i] = sinScalar((first + (float)i) + phase);
+}
+
+static void scaleScalar(float *out, const float *in, int count, float s)
+{
+    for (int i = 0; i < count; i++)
+        out[i] = in[i] * s;
+}
+
+static void fillScalar(float *out, int count, float value)
+{
+    for (int i = 0; i < count; i++)
+        out[i] = value;
+}
+
+#ifdef ALTITUDE_KERNELS_X86
+
+static inline __m128 sinSse2(__m128 x)
+{
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(INV_TWO_PI)))); // round to nearest
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_A)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_B)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_C)));
+
+    __m128 sign = _mm_and_ps(r, signMask);
+    __m128 a = _mm_andnot_ps(signMask, r);
+    a = _mm_min_ps(a, _mm_sub_ps(_mm_set1_ps(PI_F), a));
+    __m128 a2 = _mm_mul_ps(a, a);
+    __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_C9), a2), _mm_set1_ps(SIN_C7));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SIN_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SIN_C3));
+    p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SIN_C1));
+    return _mm_xor_ps(_mm_mul_ps(p, a), sign);
+}
+
+static void waveSse2(float *out, int count, float first, float phase)
+{
+    __m128 index = _mm_add_ps(_mm_set1_ps(first), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));
+    __m128 step = _mm_set1_ps(4.f);
+    __m128 ph = _mm_set1_ps(phase);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(out + i, sinSse2(_mm_add_ps(index, ph)));
+        index = _mm_add_ps(index, step);
+    }
+    for (; i < count; i++)
+        out[i] = sinScalar((first + (float)i) + phase);
+}
+
+static void scaleSse2(float *out, const float *in, int count, float s)
+{
+    __m128 sv = _mm_set1_ps(s);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), sv));
+    for (; i < count; i++)
+        out[i] = in[i] * s;
+}
+
+static void fillSse2(float *out, int count, float value)
+{
+    __m128 v = _mm_set1_ps(value);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(out + i, v);
+    for (; i < count; i++)
+        out[i] = value;
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256 sinAvx2(__m256 x)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(INV_TWO_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(TWO_PI_A), x);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(TWO_PI_B), r);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(TWO_PI_C), r);
+
+    __m256 sign = _mm256_and_ps(r, signMask);
+    __m256 a = _mm256_andnot_ps(signMask, r);
+    a = _mm256_min_ps(a, _mm256_sub_ps(_mm256_set1_ps(PI_F), a));
+    __m256 a2 = _mm256_mul_ps(a, a);
+    __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(SIN_C9), a2, _mm256_set1_ps(SIN_C7));
+    p = _mm256_fmadd_ps(p, a2, _mm256_set1_ps(SIN_C5));
+    p = _mm256_fmadd_ps(p, a2, _mm256_set1_ps(SIN_C3));
+    p = _mm256_fmadd_ps(p, a2, _mm256_set1_ps(SIN_C1));
+    return _mm256_xor_ps(_mm256_mul_ps(p, a), sign);
+}
+
+__attribute__((target("avx2,fma"))) static void waveAvx2(float *out, int count, float first, float phase)
+{
+    __m256 index = _mm256_add_ps(_mm256_set1_ps(first), _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f));
+    __m256 step = _mm256_set1_ps(8.f);
+    __m256 ph = _mm256_set1_ps(phase);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(out + i, sinAvx2(_mm256_add_ps(index, ph)));
+        index = _mm256_add_ps(index, step);
+    }
+    for (; i < count; i++)
+        out[i] = sinScalar((first + (float)i) + phase);
+}
+
+__attribute__((target("avx2"))) static void scaleAvx2(float *out, const float *in, int count, float s)
+{
+    __m256 sv = _mm256_set1_ps(s);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), sv));
+    for (; i < count; i++)
+        out[i] = in[i] * s;
+}
+
+__attribute__((target("avx2"))) static void fillAvx2(float *out, int count, float value)
+{
+    __m256 v = _mm256_set1_ps(value);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(out + i, v);
+    for (; i < count; i++)
+        out[i] = value;
+}
+
+#endif // ALTITUDE_KERNELS_X86
+
+static const AltitudeKernels kernelTable[KERNEL_ISA_COUNT] = {
+    {"scalar", waveScalar, scaleScalar, fillScalar},
+#ifdef ALTITUDE_KERNELS_X86
+    {"sse2", waveSse2, scaleSse2, fillSse2},
+    {"avx2", waveAvx2, scaleAvx2, fillAvx2},
+#else
+    {"sse2", nullptr, nullptr, nullptr},
+    {"avx2", nullptr, nullptr, nullptr},
+#endif
+};
+
+const AltitudeKernels *altitudeKernelsFor(KernelIsa isa)
+{
+    switch (isa)
+    {
+    case KERNEL_SCALAR:
+        return &kernelTable[KERNEL_SCALAR];
+#ifdef ALTITUDE_KERNELS_X86
+    case KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2") ? &kernelTable[KERNEL_SSE2] : nullptr;
+    case KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? &kernelTable[KERNEL_AVX2] : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+static const AltitudeKernels *pinnedKernels = nullptr;
+
+void pinAltitudeKernels(const AltitudeKernels *kernels)
+{
+    pinnedKernels = kernels;
+}
+
+const AltitudeKernels &altitudeKernels()
+{
+    if (pinnedKernels)
+        return *pinnedKernels;
+    static const AltitudeKernels *best = []()
+    {
+        for (int isa = KERNEL_ISA_COUNT - 1; isa > KERNEL_SCALAR; isa--)
+            if (const AltitudeKernels *kernels = altitudeKernelsFor(KernelIsa(isa)))
+                return kernels;
+        return &kernelTable[KERNEL_SCALAR];
+    }();
+    return *best;
+}
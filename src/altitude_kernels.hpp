@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * Vectorised building blocks of the altitude field, dispatched at runtime between AVX2, SSE2 and scalar code.
+ * sin() is a degree 9 odd polynomial after reduction to [-pi/2, pi/2]; its absolute error against sinf()
+ * stays below 4e-6 for |x| < 1e5 (see `make bench-kernels`), i.e. below 2e-3 px at MAX_AMPLITUDE.
+ */
+
+enum KernelIsa
+{
+    KERNEL_SCALAR = 0,
+    KERNEL_SSE2,
+    KERNEL_AVX2,
+    KERNEL_ISA_COUNT
+};
+
+struct AltitudeKernels
+{
+    const char *name;
+    void (*wave)(float *out, int count, float first, float phase);  // out[i] = sin(first + i + phase)
+    void (*scale)(float *out, const float *in, int count, float s); // out[i] = in[i] * s
+    void (*fill)(float *out, int count, float value);               // out[i] = value
+};
+
+const AltitudeKernels &altitudeKernels();                 // best kernels the CPU supports, picked once
+const AltitudeKernels *altitudeKernelsFor(KernelIsa isa); // specific ISA, nullptr if the CPU lacks it
+void pinAltitudeKernels(const AltitudeKernels *kernels);  // altitudeKernels() returns these until nullptr restores the pick, for benchmarks
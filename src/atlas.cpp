@@ -0,0 +1,87 @@
+#include "atlas.hpp"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+bool buildTileAtlas(TileAtlas &atlas, string files[], size_t count, bool upload)
+{
+    atlas = {};
+    if (count == 0 || count > IMG_ARRAY_SIZE)
+        return false;
+
+    Image images[IMG_ARRAY_SIZE] = {};
+    for (size_t i = 0; i < count; i++)
+    {
+        images[i] = LoadImage(files[i].c_str());                              // upload to RAM
+        if (!images[i].data)
+        {
+            cout << "Failed to load image (" << files[i] << ")\n";
+            for (size_t j = 0; j < i; j++)
+                UnloadImage(images[j]);
+            return false;
+        }
+        ImageResizeNN(&images[i], images[i].width * 2, images[i].height * 2); // 32x32 -> 64x64 (w/ nearest neighbour)
+        ImageFormat(&images[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);           // same layout as the atlas, rows can be copied as is
+    }
+
+    /**
+     * Shelf packing: tiles are laid out left to right and wrap onto a new shelf
+     * once ATLAS_MAX_WIDTH is reached. ATLAS_PADDING transparent pixels separate
+     * neighbours so no tile can bleed into another one.
+     */
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    int penX = 0;
+    int penY = 0;
+    int shelfHeight = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (penX > 0 && penX + images[i].width > ATLAS_MAX_WIDTH)
+        {
+            penX = 0;
+            penY += shelfHeight + ATLAS_PADDING;
+            shelfHeight = 0;
+        }
+        atlas.rects[i] = {(float)penX, (float)penY, (float)images[i].width, (float)images[i].height};
+        penX += images[i].width + ATLAS_PADDING;
+        shelfHeight = max(shelfHeight, images[i].height);
+        atlasWidth = max(atlasWidth, penX);
+        atlasHeight = max(atlasHeight, penY + shelfHeight);
+    }
+
+    Image atlasImg = GenImageColor(atlasWidth, atlasHeight, BLANK);
+    unsigned char *dst = static_cast<unsigned char *>(atlasImg.data);
+    for (size_t i = 0; i < count; i++)
+    {
+        const unsigned char *src = static_cast<const unsigned char *>(images[i].data);
+        size_t rowBytes = static_cast<size_t>(images[i].width) * 4;
+        for (int row = 0; row < images[i].height; row++)
+        {
+            size_t dstOffset = (static_cast<size_t>(atlas.rects[i].y) + static_cast<size_t>(row)) * static_cast<size_t>(atlasWidth) * 4 +
+                               static_cast<size_t>(atlas.rects[i].x) * 4;
+            memcpy(dst + dstOffset, src + static_cast<size_t>(row) * rowBytes, rowBytes);
+        }
+        UnloadImage(images[i]); // unload from RAM
+    }
+
+    if (upload)
+        atlas.texture = LoadTextureFromImage(atlasImg); // upload to VRAM
+    atlas.image = atlasImg;                             // kept in RAM for CPU rendering
+    atlas.tileWidth = static_cast<int>(atlas.rects[0].width);
+    atlas.tileHeight = static_cast<int>(atlas.rects[0].height);
+    atlas.count = static_cast<int>(count);
+
+    cout << "Packed " << count << " tiles into a " << atlasWidth << "x" << atlasHeight << " atlas\n";
+    return !upload || atlas.texture.id != 0;
+}
+
+void unloadTileAtlas(TileAtlas &atlas)
+{
+    if (atlas.texture.id)
+        UnloadTexture(atlas.texture);
+    if (atlas.image.data)
+        UnloadImage(atlas.image);
+    atlas = {};
+}
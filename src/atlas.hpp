@@ -0,0 +1,21 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <string>
+
+#include "definitions.hpp"
+
+// All tile images packed into one texture, so the whole grid can be drawn without texture switches
+struct TileAtlas
+{
+    Texture texture;                   // packed texture in VRAM (id 0 when built without a GPU)
+    Image image;                       // same pixels in RAM (RGBA8), read by the software renderer
+    Rectangle rects[IMG_ARRAY_SIZE];   // source rectangle of every tile inside the texture
+    int tileWidth;                     // size of an individual (resized) tile
+    int tileHeight;
+    int count;                         // number of tiles packed
+};
+
+bool buildTileAtlas(TileAtlas &atlas, std::string files[], size_t count, bool upload = true); // upload: also create the texture
+void unloadTileAtlas(TileAtlas &atlas);
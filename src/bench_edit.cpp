@@ -0,0 +1,113 @@
+// Tile painting and undo benchmark, built and run by `make bench-edit`
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "definitions.hpp"
+#include "edit_log.hpp"
+#include "tile_map.hpp"
+
+using namespace std;
+
+#define FRAME_MS (1000.0 / FPS)
+#define FILL_BUDGET_MS (4 * FRAME_MS) // paint + diff of a fill over the whole 4096x4096 map, a short hitch at most
+
+// FNV-1a over the tiles in use, equal for identical maps
+static uint64_t checksum(const TileMap &map)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (int row = 0; row < map.size; row++)
+        for (int col = 0; col < map.size; col++)
+            h = (h ^ static_cast<uint64_t>(static_cast<TileId>(tileAt(map, col, row)))) * 1099511628211ULL;
+    return h;
+}
+
+template <typename F>
+static double timeMs(F run)
+{
+    auto start = chrono::steady_clock::now();
+    run();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static size_t logBytes(const EditLog &log)
+{
+    return log.undo.empty() ? 0 : editCommandBytes(log.undo.back());
+}
+
+// edit, then undo and redo it, checking both land on the exact maps; returns the paint + diff ms
+template <typename F>
+static double measure(const char *name, TileMap &map, EditLog &log, F edit)
+{
+    uint64_t original = checksum(map);
+    int changed = 0;
+    double paintMs = timeMs([&]
+                            { beginEdit(log); changed = edit(); });
+    double diffMs = timeMs([&]
+                           { endEdit(log, map); });
+    uint64_t edited = checksum(map);
+    size_t runs = log.undo.empty() ? 0 : log.undo.back().runs.size();
+    size_t bytes = logBytes(log);
+
+    double undoMs = timeMs([&]
+                           { undoEdit(log, map); });
+    bool undone = checksum(map) == original;
+    double redoMs = timeMs([&]
+                           { redoEdit(log, map); });
+    bool redone = checksum(map) == edited;
+
+    printf("%-22s %10d %9.2f %8.2f %9zu %10.1f %8.3f %8.3f %9s\n", name, changed, paintMs, diffMs, runs, (double)bytes / 1024.0,
+           undoMs, redoMs, undone && redone ? "yes" : "NO");
+    return paintMs + diffMs;
+}
+
+int main()
+{
+    const int size = MAX_GRID_SIZE;
+    AliasTable sampler;
+    buildAliasTable(sampler, normalTileWeights(IMG_ARRAY_SIZE, DIST_STDDEV));
+    TileMap map;
+    generateTileMap(map, size, sampler, 42, workerPool());
+    EditLog log;
+    initEditLog(log, EDIT_LOG_BUDGET);
+
+    printf("%dx%d map, one frame is %.1f ms\n", size, size, FRAME_MS);
+    printf("%-22s %10s %9s %8s %9s %10s %8s %8s %9s\n", "edit", "changed", "paint ms", "diff ms", "runs", "KiB", "undo ms",
+           "redo ms", "restored");
+
+    double fillMs = measure("full map fill", map, log, [&]
+                            { return paintRect(log, map, 0, 0, size - 1, size - 1, 1); });
+    measure("rect 1000x1000", map, log, [&]
+            { return paintRect(log, map, 500, 700, 1499, 1699, 3); });
+    measure("stroke r8, 600 frames", map, log, [&]
+            {
+                // mouse moving 7 tiles a frame in a loop over the map, one command for the whole stroke
+                int changed = 0, col = 100, row = 100;
+                for (int frame = 0; frame < 600; frame++)
+                {
+                    int nextCol = 100 + (frame * 7) % (size - 200), nextRow = 100 + (frame * 13) % (size - 200);
+                    changed += paintStroke(log, map, col, row, nextCol, nextRow, 8, (TileId)(frame / 200));
+                    col = nextCol;
+                    row = nextRow;
+                }
+                return changed; });
+    double floodMs = measure("flood fill (map)", map, log, [&]
+                             { return floodFill(log, map, 0, 0, 4); });
+    bool inBudget = fillMs <= FILL_BUDGET_MS && floodMs <= FILL_BUDGET_MS;
+    printf("full map fills within %.0f ms: %s\n", FILL_BUDGET_MS, inBudget ? "yes" : "NO");
+
+    // the oldest commands go once the budget is exceeded; a fresh map each time so every fill keeps 16 MiB of old tiles
+    clearEditLog(log);
+    int fills = 0;
+    for (TileId tile = 0; tile < 8; tile++, fills++)
+    {
+        generateTileMap(map, size, sampler, 42 + tile, workerPool());
+        beginEdit(log);
+        paintRect(log, map, 0, 0, size - 1, size - 1, tile % IMG_ARRAY_SIZE);
+        endEdit(log, map);
+    }
+    printf("\n%d full map fills with a %.0f MiB budget: %zu undoable, %.1f MiB held\n", fills, (double)EDIT_LOG_BUDGET / 1048576.0,
+           log.undo.size(), (double)log.bytes / 1048576.0);
+    return inBudget ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Microbenchmark and accuracy check of the altitude kernels, built and run by `make bench-kernels`
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "definitions.hpp"
+#include "altitude.hpp"
+#include "altitude_kernels.hpp"
+
+using namespace std;
+
+#define BENCH_GRID 2048  // tiles per side of the field evaluated each repetition
+#define BENCH_REPEATS 20
+
+// the per-tile getAlt() drawGame() used before the altitude field, the ground truth
+static float referenceAltitude(int row, int col, float t, float speed, float amp, int option)
+{
+    switch (option)
+    {
+    case 1:
+        return sinf((float)row + t * speed) * amp;
+    case 2:
+        return sinf((float)col + t * speed) * amp;
+    default:
+        return sinf((float)row + t * speed) * sinf((float)col + t * speed) * amp;
+    }
+}
+
+// the field drawTiles() reads, built and read row by row the way it does with whatever kernels are pinned
+static void evaluateField(AltitudeField &field, int size, float t, float speed, float amp, unsigned short option, vector<float> &out)
+{
+    updateAltitudeField(field, size, t, speed, amp, option);
+    for (int row = 0; row < size; row++)
+        altitudeRow(field, row, 0, size, out.data() + static_cast<size_t>(row) * static_cast<size_t>(size));
+}
+
+int main()
+{
+    const int size = BENCH_GRID;
+    const float amp = MAX_AMPLITUDE;
+    const float speed = OSCIl_SPEED;
+    const float times[] = {0.f, 1.7f, 987.25f, 40000.f};
+    const double tiles = double(size) * double(size);
+
+    AltitudeField field;
+    vector<float> out(static_cast<size_t>(size) * static_cast<size_t>(size));
+
+    printf("grid %dx%d, amplitude %.0f\n", size, size, (double)amp);
+    printf("%-8s %-7s %12s %16s\n", "isa", "option", "ns/tile", "max error (px)");
+
+    // baseline: one or two sinf per tile
+    for (int option = 1; option <= 3; option++)
+    {
+        volatile float sink = 0.f;
+        auto start = chrono::steady_clock::now();
+        for (int rep = 0; rep < BENCH_REPEATS / 4; rep++)
+            for (int row = 0; row < size; row++)
+                for (int col = 0; col < size; col++)
+                    sink = sink + referenceAltitude(row, col, 1.7f, speed, amp, option);
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        printf("%-8s %-7d %12.3f %16s\n", "sinf", option, ns / (tiles * (BENCH_REPEATS / 4)), "-");
+    }
+
+    int failures = 0;
+    for (int isa = 0; isa < KERNEL_ISA_COUNT; isa++)
+    {
+        const AltitudeKernels *k = altitudeKernelsFor(KernelIsa(isa));
+        if (!k)
+        {
+            printf("%-8s unsupported on this CPU\n", isa == KERNEL_SSE2 ? "sse2" : "avx2");
+            continue;
+        }
+
+        pinAltitudeKernels(k);
+        for (unsigned short option = 1; option <= 3; option++)
+        {
+            double maxError = 0.0;
+            for (float t : times)
+            {
+                evaluateField(field, size, t, speed, amp, option, out);
+                for (int row = 0; row < size; row++)
+                    for (int col = 0; col < size; col++)
+                    {
+                        double e = fabs(double(out[static_cast<size_t>(row) * static_cast<size_t>(size) + static_cast<size_t>(col)]) -
+                                        double(referenceAltitude(row, col, t, speed, amp, option)));
+                        maxError = e > maxError ? e : maxError;
+                    }
+            }
+
+            auto start = chrono::steady_clock::now();
+            for (int rep = 0; rep < BENCH_REPEATS; rep++)
+                evaluateField(field, size, 1.7f + (float)rep, speed, amp, option, out);
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+            printf("%-8s %-7d %12.3f %16.6f%s\n", k->name, option, ns / (tiles * BENCH_REPEATS), maxError, maxError < 1.0 ? "" : "  FAIL (>= 1 px)");
+            failures += maxError >= 1.0;
+        }
+    }
+    pinAltitudeKernels(nullptr);
+    printf("runtime dispatch picks: %s\n", altitudeKernels().name);
+    return failures ? 1 : 0;
+}
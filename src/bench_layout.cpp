@@ -0,0 +1,130 @@
+// Tile map layout benchmark, chunked Z-order store against a flat row-major array, built and run by `make bench-layout`.
+// `bench_layout.out flat` / `bench_layout.out chunked` run one layout only, for `perf stat`.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "definitions.hpp"
+#include "iso.hpp"
+#include "tile_map.hpp"
+
+using namespace std;
+
+#define LAYOUT_GRID 16384    // tiles per side, far larger than any cache
+#define LAYOUT_WINDOWS 64    // camera positions walked per zoom level
+#define LAYOUT_TILE_W 64
+#define LAYOUT_TILE_H 32
+#define LAYOUT_ZOOMS {1, 4, 16} // view size in screens, what a zoomed out camera culls to
+
+// Grid origin that puts tile (col, row) in the middle of a view of width x height, inverse of tileScreenPosition()
+static Vector2 centreOn(int col, int row, float width, float height)
+{
+    Vector2 iso = transform({float(col * LAYOUT_TILE_W), float(row * LAYOUT_TILE_H)});
+    return {width / 2.f - iso.x / 2.f + (float)(LAYOUT_TILE_W / 2),
+            height / 2.f - iso.y / 2.f + (float)(LAYOUT_TILE_H * LAYOUT_GRID / 4)};
+}
+
+// Row after row through the visible columns, what drawTiles() did on the flat vector
+static uint64_t walkFlat(const vector<TileId> &flat, const VisibleTiles &visible, size_t &tiles)
+{
+    uint64_t sum = 0;
+    for (int row = visible.rowBegin; row < visible.rowEnd; row++)
+    {
+        int colBegin, colEnd;
+        if (!visibleCols(visible, row, colBegin, colEnd))
+            continue;
+        const TileId *ids = flat.data() + static_cast<size_t>(row) * LAYOUT_GRID;
+        for (int col = colBegin; col < colEnd; col++)
+            sum += ids[col] * static_cast<uint64_t>(col + 1);
+        tiles += static_cast<size_t>(colEnd - colBegin);
+    }
+    return sum;
+}
+
+// Chunk by chunk in iso draw order, what drawTiles() does now
+static uint64_t walkChunked(const TileMap &map, const VisibleTiles &visible, size_t &tiles)
+{
+    uint64_t sum = 0;
+    ChunkBand band;
+    TileSpan<const TileId> ids = tileIds(map);
+    const int mask = TILE_CHUNK_SIZE - 1;
+    int chunkRowBegin;
+    int chunkRows = visibleChunkRows(visible, chunkRowBegin);
+    for (int chunkRow = chunkRowBegin; chunkRow < chunkRowBegin + chunkRows; chunkRow++)
+    {
+        if (!visibleChunkBand(visible, chunkRow, band))
+            continue;
+        for (int chunkCol = band.chunkColBegin; chunkCol < band.chunkColEnd; chunkCol++)
+        {
+            const TileId *chunk = ids.chunk(chunkCol, chunkRow);
+            for (int row = band.rowBegin; row < band.rowEnd; row++)
+            {
+                int i = row - band.rowBegin;
+                int colBegin = max(band.colBegin[i], chunkCol << TILE_CHUNK_SHIFT);
+                int colEnd = min(band.colEnd[i], (chunkCol + 1) << TILE_CHUNK_SHIFT);
+                const TileId *chunkRowIds = chunk + ((row & mask) << TILE_CHUNK_SHIFT);
+                for (int col = colBegin; col < colEnd; col++)
+                    sum += chunkRowIds[col & mask] * static_cast<uint64_t>(col + 1);
+                tiles += static_cast<size_t>(max(colEnd - colBegin, 0));
+            }
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    bool runFlat = argc < 2 || strcmp(argv[1], "flat") == 0;
+    bool runChunked = argc < 2 || strcmp(argv[1], "chunked") == 0;
+
+    AliasTable sampler;
+    buildAliasTable(sampler, normalTileWeights(IMG_ARRAY_SIZE, DIST_STDDEV));
+    TileMap map = {};
+    generateTileMap(map, LAYOUT_GRID, sampler, 42, workerPool());
+
+    vector<TileId> flat;
+    if (runFlat)
+    {
+        flat.resize(static_cast<size_t>(LAYOUT_GRID) * LAYOUT_GRID);
+        for (int row = 0; row < LAYOUT_GRID; row++)
+            for (int col = 0; col < LAYOUT_GRID; col++)
+                flat[static_cast<size_t>(row) * LAYOUT_GRID + static_cast<size_t>(col)] = (TileId)tileAt(map, col, row);
+    }
+    if (!runChunked)
+        map = {}; // only the flat copy in memory while perf watches
+
+    printf("grid %dx%d, %d windows per zoom\n", LAYOUT_GRID, LAYOUT_GRID, LAYOUT_WINDOWS);
+    printf("%-6s %-9s %12s %12s %10s\n", "zoom", "layout", "tiles/window", "ns/tile", "checksum");
+    const int zooms[] = LAYOUT_ZOOMS;
+    for (int zoom : zooms)
+    {
+        float width = (float)(SCREEN_WIDTH * zoom), height = (float)(SCREEN_HEIGHT * zoom);
+        vector<VisibleTiles> windows;
+        Pcg32 rng;
+        seedRng(rng, 7);
+        for (int w = 0; w < LAYOUT_WINDOWS; w++)
+        {
+            int col = LAYOUT_GRID / 8 + (int)(nextFloat(rng) * LAYOUT_GRID * 3 / 4);
+            int row = LAYOUT_GRID / 8 + (int)(nextFloat(rng) * LAYOUT_GRID * 3 / 4);
+            windows.push_back(visibleTiles(centreOn(col, row, width, height), LAYOUT_GRID, LAYOUT_TILE_W, LAYOUT_TILE_H,
+                                           {0, 0, width, height}, MAX_AMPLITUDE));
+        }
+
+        for (int layout = 0; layout < 2; layout++)
+        {
+            if ((layout == 0 && !runFlat) || (layout == 1 && !runChunked))
+                continue;
+            size_t tiles = 0;
+            uint64_t sum = 0;
+            auto start = chrono::steady_clock::now();
+            for (const VisibleTiles &visible : windows)
+                sum += layout == 0 ? walkFlat(flat, visible, tiles) : walkChunked(map, visible, tiles);
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            printf("%-6d %-9s %12zu %12.3f %10llx\n", zoom, layout == 0 ? "flat" : "chunked", tiles / LAYOUT_WINDOWS,
+                   ns / (double)tiles, (unsigned long long)(sum & 0xFFFFFFFFFFull));
+        }
+    }
+    return 0;
+}
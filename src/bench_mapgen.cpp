@@ -0,0 +1,187 @@
+// Tile map regeneration benchmark, built and run by `make bench-mapgen`
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "definitions.hpp"
+#include "tile_map.hpp"
+
+using namespace std;
+
+#define BENCH_REPEATS 5
+#define SCALING_SIZES {1024, 4096, 16384}
+
+// what arrangeRandomTiles() did before the seeded generator: a new random_device and mt19937 per call
+static void legacyTileMap(vector<int> &tileMap, int size, int tileCount, float stddev)
+{
+    random_device rd;
+    mt19937 gen(rd());
+
+    float mean = floor((float)tileCount / 2.f);
+    normal_distribution<float> dist(mean, stddev);
+    tileMap.resize(static_cast<size_t>(size) * static_cast<size_t>(size));
+
+    for (size_t i = 0; i < tileMap.size(); i++)
+    {
+        double x;
+        do
+        {
+            x = dist(gen);
+        } while (x < 0.0f || x > (float)(tileCount)-1);
+        tileMap[i] = int(round(x));
+    }
+}
+
+// largest gap between how often each tile occurs in `map` and the chance it should have
+template <typename T>
+static double maxFrequencyError(const vector<T> &map, const vector<double> &weights)
+{
+    vector<double> counts(weights.size(), 0.0);
+    for (T tile : map)
+        counts[static_cast<size_t>(tile)] += 1.0;
+    double total = 0.0, error = 0.0;
+    for (double weight : weights)
+        total += weight;
+    for (size_t i = 0; i < weights.size(); i++)
+        error = max(error, fabs(counts[i] / (double)map.size() - weights[i] / total));
+    return error;
+}
+
+static double maxFrequencyError(const TileMap &map, const vector<double> &weights)
+{
+    vector<TileId> tiles; // in-use tiles only, chunks at the edge have unused slots
+    tiles.reserve(static_cast<size_t>(map.size) * static_cast<size_t>(map.size));
+    for (int row = 0; row < map.size; row++)
+        for (int col = 0; col < map.size; col++)
+            tiles.push_back((TileId)tileAt(map, col, row));
+    return maxFrequencyError(tiles, weights);
+}
+
+// FNV-1a over the map, equal for bit-identical maps
+static uint64_t checksum(const vector<TileId> &map)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (TileId tile : map)
+        h = (h ^ static_cast<uint64_t>(tile)) * 1099511628211ULL;
+    return h;
+}
+
+// best of BENCH_REPEATS runs; a callable returning double reports its own timed part in ms
+template <typename F>
+static double bestMs(F run)
+{
+    double best = 1e30;
+    for (int r = 0; r < BENCH_REPEATS; r++)
+    {
+        auto start = chrono::steady_clock::now();
+        double ms;
+        if constexpr (is_same_v<decltype(run()), double>)
+            ms = run();
+        else
+        {
+            run();
+            ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+        best = min(best, ms);
+    }
+    return best;
+}
+
+int main()
+{
+    const int sizes[] = {GRID_SIZE, 1024, MAX_GRID_SIZE};
+    const float stddevs[] = {0.f, 0.5f, (float)DIST_STDDEV, 3.f};
+    vector<int> legacyMap;
+    TileMap map, again;
+    ThreadPool single(1);
+
+    printf("single thread\n");
+    printf("%-6s %-7s %11s %11s %8s %12s %11s %11s\n", "grid", "stddev", "legacy ms", "alias ms", "speedup",
+           "reproducible", "legacy err", "alias err");
+    for (int size : sizes)
+    {
+        for (float stddev : stddevs)
+        {
+            vector<double> weights = normalTileWeights(IMG_ARRAY_SIZE, stddev);
+            AliasTable sampler;
+            buildAliasTable(sampler, weights);
+
+            double legacy = bestMs([&]
+                                   { legacyTileMap(legacyMap, size, IMG_ARRAY_SIZE, stddev); });
+            double legacyError = maxFrequencyError(legacyMap, weights);
+            double alias = bestMs([&]
+                                  { generateTileMap(map, size, sampler, 42, single); });
+            generateTileMap(again, size, sampler, 42, single);
+            printf("%-6d %-7.1f %11.3f %11.3f %7.1fx %12s %11.5f %11.5f\n", size, (double)stddev, legacy, alias, legacy / alias,
+                   map.ids == again.ids ? "yes" : "NO", legacyError, maxFrequencyError(map, weights));
+        }
+    }
+
+    // thread scaling, the map must not depend on the thread count
+    unsigned int hardware = max(1u, thread::hardware_concurrency());
+    vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < hardware; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(hardware);
+
+    AliasTable sampler;
+    buildAliasTable(sampler, normalTileWeights(IMG_ARRAY_SIZE, DIST_STDDEV));
+    printf("\nscaling, %u hardware threads\n", hardware);
+    printf("%-6s %-8s %11s %9s %10s %10s\n", "grid", "threads", "ms", "speedup", "Mtiles/s", "identical");
+    const int scalingSizes[] = SCALING_SIZES;
+    for (int size : scalingSizes)
+    {
+        double base = 0.0;
+        uint64_t reference = 0;
+        for (unsigned int threads : threadCounts)
+        {
+            ThreadPool pool(threads);
+            double ms = bestMs([&]
+                               { generateTileMap(map, size, sampler, 42, pool); });
+            uint64_t sum = checksum(map.ids);
+            if (threads == 1)
+            {
+                base = ms;
+                reference = sum;
+            }
+            printf("%-6d %-8u %11.3f %8.2fx %10.1f %10s\n", size, threads, ms, base / ms,
+                   double(size) * double(size) / (ms * 1000.0), sum == reference ? "yes" : "NO");
+        }
+    }
+
+    // growing keeps the old tiles and only draws the border, the result must equal a fresh map of the new size
+    printf("\nresize (all threads)\n");
+    printf("%-12s %12s %12s %12s %10s\n", "grid", "first ms", "grown ms", "regen ms", "identical");
+    const int resizes[][2] = {{1024, 1025}, {1024, 2048}, {4095, 4096}, {2048, 4096}};
+    ThreadPool &pool = workerPool();
+    auto timedResize = [&](int from, int to, bool grown)
+    {
+        return bestMs([&]
+                      {
+                          // grown: one step up first, so the allocation already has room like after earlier presses of O
+                          generateTileMap(map, grown ? from - 1 : from, sampler, 42, pool);
+                          if (grown)
+                              resizeTileMap(map, from, sampler, pool);
+                          auto start = chrono::steady_clock::now();
+                          resizeTileMap(map, to, sampler, pool);
+                          return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(); });
+    };
+    for (const int *step : resizes)
+    {
+        double first = timedResize(step[0], step[1], false);
+        double grown = timedResize(step[0], step[1], true);
+        double regen = bestMs([&]
+                              { generateTileMap(again, step[1], sampler, 42, pool); });
+        bool identical = true;
+        for (int row = 0; row < step[1] && identical; row++)
+            for (int col = 0; col < step[1] && identical; col++)
+                identical = tileAt(map, col, row) == tileAt(again, col, row);
+        printf("%5d->%-5d %12.3f %12.3f %12.3f %10s\n", step[0], step[1], first, grown, regen, identical ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Software frame redrawn only where tiles changed against redrawn whole, built and run by `make bench-redraw`
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "altitude.hpp"
+#include "atlas.hpp"
+#include "definitions.hpp"
+#include "iso.hpp"
+#include "software_renderer.hpp"
+#include "thread_pool.hpp"
+
+using namespace std;
+
+#define FRAMES 240
+#define TIME_STEP (1.0f / 60.0f)
+#define GRID 40 // fills the 1200x800 frame at zoom 1
+
+// Oscillation option 3 of a GRID x GRID field at time t, as drawTiles() hands it to the software renderer
+static void submitField(SoftwareRenderer &renderer, const TileAtlas &atlas, AltitudeField &field, float speed, float amplitude, float t)
+{
+    static vector<float> altitudes(GRID);
+    beginSoftwareFrame(renderer, SCREEN_WIDTH, SCREEN_HEIGHT, BLACK, WHITE);
+    updateAltitudeField(field, GRID, t, speed, amplitude, 3);
+    Vector2 startPos = {((float)SCREEN_WIDTH - (float)atlas.tileWidth) / 2.f, (float)SCREEN_HEIGHT / 2.f};
+    for (int row = 0; row < GRID; row++)
+    {
+        altitudeRow(field, row, 0, GRID, altitudes.data());
+        for (int col = 0; col < GRID; col++)
+        {
+            Vector2 pos = tileScreenPosition(col, row, atlas.tileWidth, atlas.tileHeight, startPos, GRID, altitudes[static_cast<size_t>(col)]);
+            pushSoftwareTile(renderer, (int)pos.x, (int)pos.y, (row * 7 + col * 3) % IMG_ARRAY_SIZE);
+        }
+    }
+}
+
+int main()
+{
+    SetTraceLogLevel(LOG_ERROR);
+    string files[IMG_ARRAY_SIZE] = {"assets/tile_1.png", "assets/tile_2.png", "assets/tile_3.png", "assets/tile_4.png", "assets/tile_5.png"};
+    TileAtlas atlas;
+    if (!buildTileAtlas(atlas, files, IMG_ARRAY_SIZE, false))
+        return 1;
+    SoftwareRenderer full, incremental;
+    initSoftwareRenderer(full, atlas);
+    initSoftwareRenderer(incremental, atlas);
+    incremental.incremental = true;
+    AltitudeField fullField, incrementalField;
+    size_t frameBytes = (size_t)SCREEN_WIDTH * SCREEN_HEIGHT * 4;
+
+    printf("%dx%d grid, %dx%d frame, %d frames at %.0f fps\n", GRID, GRID, SCREEN_WIDTH, SCREEN_HEIGHT, FRAMES, 1.f / TIME_STEP);
+    printf("%-7s %-10s %10s %10s %10s %10s %10s\n", "speed", "amplitude", "full ms", "incr ms", "redrawn", "regions", "identical");
+    int failures = 0;
+    for (float amplitude : {32.f, 160.f})
+        for (float speed : {0.f, 0.05f, 0.2f, 0.5f, 2.f})
+        {
+            double fullMs = 0.0, incrementalMs = 0.0;
+            long long redrawn = 0, regions = 0;
+            bool identical = true;
+            for (int frame = 0; frame < FRAMES; frame++)
+            {
+                float t = (float)frame * TIME_STEP;
+                auto start = chrono::steady_clock::now();
+                submitField(full, atlas, fullField, speed, amplitude, t);
+                renderSoftwareFrame(full, workerPool());
+                auto middle = chrono::steady_clock::now();
+                submitField(incremental, atlas, incrementalField, speed, amplitude, t);
+                renderSoftwareFrame(incremental, workerPool());
+                auto end = chrono::steady_clock::now();
+                fullMs += chrono::duration<double, milli>(middle - start).count();
+                incrementalMs += chrono::duration<double, milli>(end - middle).count();
+
+                for (const SoftwareRect &region : incremental.dirty)
+                    redrawn += (long long)(region.x1 - region.x0) * (region.y1 - region.y0);
+                regions += (long long)incremental.dirty.size();
+                identical = identical && memcmp(full.frame.data, incremental.frame.data, frameBytes) == 0;
+            }
+            printf("%-7.2f %-10.0f %10.3f %10.3f %9.1f%% %10.1f %10s\n", speed, amplitude, fullMs / FRAMES, incrementalMs / FRAMES,
+                   100.0 * (double)redrawn / ((double)FRAMES * SCREEN_WIDTH * SCREEN_HEIGHT), (double)regions / FRAMES, identical ? "yes" : "NO");
+            failures += !identical;
+        }
+
+    unloadSoftwareRenderer(full);
+    unloadSoftwareRenderer(incremental);
+    unloadTileAtlas(atlas);
+    return failures ? 1 : 0;
+}
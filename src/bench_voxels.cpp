@@ -0,0 +1,128 @@
+// Voxel stack culling and mask update benchmark, built and run by `make bench-voxels`
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "definitions.hpp"
+#include "random.hpp"
+#include "tile_map.hpp"
+#include "voxel_stacks.hpp"
+
+using namespace std;
+
+#define LAYER_PIXELS 16.f // VOXEL_LAYER_HEIGHT of the 64 pixel tiles drawn at lod 1
+
+template <typename F>
+static double timeMs(F run)
+{
+    auto start = chrono::steady_clock::now();
+    run();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static float waveAltitude(int col, int row, float amplitude)
+{
+    return sinf((float)row + 1.25f) * sinf((float)col + 1.25f) * amplitude; // oscillation option 3 at t = 1.25
+}
+
+// Every mask rebuilt from the solid layers, what updating them on each frame would cost
+static size_t checkMasks(const VoxelStacks &stacks, int &wrong)
+{
+    auto layersAt = [&](int col, int row)
+    {
+        if (col >= stacks.size || row >= stacks.size)
+            return 0u;
+        const VoxelColumn *column = voxelColumn(stacks, col, row);
+        return column ? column->solid : 1u;
+    };
+    size_t checked = 0;
+    wrong = 0;
+    for (const auto &[key, chunk] : stacks.chunks)
+        for (const VoxelColumn &column : chunk.columns)
+        {
+            int col = ((int)(uint32_t)key << TILE_CHUNK_SHIFT) + (column.cell & (TILE_CHUNK_SIZE - 1));
+            int row = ((int)(uint32_t)(key >> 32) << TILE_CHUNK_SHIFT) + (column.cell >> TILE_CHUNK_SHIFT);
+            wrong += column.top != (column.solid & (column.solid >> 1)) || column.right != layersAt(col + 1, row) ||
+                     column.left != layersAt(col, row + 1);
+            checked++;
+        }
+    return checked;
+}
+
+static void countLayers(const VoxelStacks &stacks, float amplitude, size_t &total, size_t &drawn)
+{
+    total = drawn = 0;
+    for (int row = 0; row < stacks.size; row++)
+        for (int col = 0; col < stacks.size; col++)
+        {
+            const VoxelColumn *column = voxelColumn(stacks, col, row);
+            if (!column)
+            {
+                total++;
+                drawn++;
+                continue;
+            }
+            float altitude = waveAltitude(col, row, amplitude);
+            uint32_t layers = visibleVoxelLayers(*column, altitude, waveAltitude(col + 1, row, amplitude), waveAltitude(col, row + 1, amplitude), LAYER_PIXELS);
+            total += (size_t)__builtin_popcount(column->solid);
+            drawn += (size_t)__builtin_popcount(layers);
+        }
+}
+
+int main()
+{
+    const int size = 1024;
+    AliasTable sampler;
+    buildAliasTable(sampler, normalTileWeights(IMG_ARRAY_SIZE, DIST_STDDEV));
+    TileMap map;
+    generateTileMap(map, size, sampler, 42, workerPool());
+    VoxelStacks stacks;
+    clearVoxelStacks(stacks, size);
+
+    const int hills = 1500; // most of the map is hills
+    double raiseMs = timeMs([&]
+                            { raiseVoxelHills(stacks, map, 42, hills); });
+    printf("%dx%d map, %d hills: %zu columns, %.1f MiB, raised in %.1f ms\n", size, size, hills, stacks.columns,
+           (double)voxelStacksBytes(stacks) / 1048576.0, raiseMs);
+
+    printf("%-10s %12s %12s %8s\n", "amplitude", "tiles", "drawn", "hidden");
+    for (float amplitude : {0.f, 8.f, 32.f, 160.f})
+    {
+        size_t total, drawn;
+        countLayers(stacks, amplitude, total, drawn);
+        printf("%-10.0f %12zu %12zu %7.1f%%\n", amplitude, total, drawn, 100.0 * (double)(total - drawn) / (double)total);
+    }
+
+    // random stacking and removal, each edit only touches the masks of its column and the two behind it
+    Pcg32 rng;
+    seedRng(rng, 7);
+    const int edits = 200000;
+    double editMs = timeMs([&]
+                           {
+                               for (int i = 0; i < edits; i++)
+                               {
+                                   int col = (int)(nextU32(rng) % (uint32_t)size), row = (int)(nextU32(rng) % (uint32_t)size);
+                                   int layer = 1 + (int)(nextU32(rng) % (VOXEL_MAX_LAYERS - 1));
+                                   setVoxel(stacks, col, row, layer, (TileId)(nextU32(rng) % IMG_ARRAY_SIZE), nextU32(rng) & 1);
+                               }
+                           });
+    int wrong = 0;
+    size_t checked = 0;
+    double rebuildMs = timeMs([&]
+                              { checked = checkMasks(stacks, wrong); });
+    printf("\n%d edits: %.3f us each; rebuilding all %zu columns' masks takes %.2f ms, %d differ from the updated ones\n", edits,
+           editMs * 1000.0 / edits, checked, rebuildMs, wrong);
+
+    // shrinking and growing the map changes which neighbours exist
+    int failures = wrong;
+    for (int resized : {700, 1000, 1024})
+    {
+        resizeVoxelStacks(stacks, resized);
+        checkMasks(stacks, wrong);
+        printf("resized to %d: %d columns' masks differ\n", resized, wrong);
+        failures += wrong;
+    }
+    return failures ? 1 : 0;
+}
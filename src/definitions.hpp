@@ -8,12 +8,80 @@
 #define BG_COLOR BLACK
 
 #define IMG_ARRAY_SIZE 5
+#define ATLAS_MAX_WIDTH 2048              // tiles wrap onto a new shelf of the atlas past this width
+#define ATLAS_PADDING 2                   // transparent gap between packed tiles
 #define AMPLITUDE 32                      // determins the height of each individual tile
 #define MAX_AMPLITUDE (AMPLITUDE * 5)     // max height of an individual tile allowed
 #define OSCIl_SPEED 2                     // oscillation speed
 #define MAX_OSCIL_SPEED (OSCIl_SPEED * 3) // max oscillation speed allowed
 #define GRID_SIZE 15                      // GRID_SIZE * GRID_SIZE is the total number of tiles
-#define MAX_GRID_SIZE 50                  // max grid size allowed
+#define MAX_GRID_SIZE 4096                // max grid size allowed, only the visible tiles are visited
+#define GPU_GRID_MAX_SIZE 1024            // largest grid the static GPU buffer is built for (6 vertices * 8 bytes per tile)
 #define OSCIL_OPTION 3                    // different height functions for an indivdual tile
 #define DIST_STDDEV 2
+#define MAP_SEED -1                       // tile map seed (--seed), negative for a new random map each time
+#define TILE_CHUNK_SHIFT 5                // the tile map is stored in chunks of 32x32 tiles
+#define TILE_CHUNK_SIZE (1 << TILE_CHUNK_SHIFT)
+
+#define WORLD_MODE false                  // start in the unbounded streaming world instead of the gridSize map, toggled with W
+#define WORLD_MEMORY_BUDGET (16 << 20)    // bytes of generated chunks kept before the least recently used are dropped
+#define WORLD_GENERATOR_THREADS 2         // background threads generating world chunks
+#define WORLD_MAX_PENDING 64              // chunks queued for generation at once
+#define WORLD_PREFETCH_CHUNKS 2           // chunks requested ahead of the camera along its motion
+#define WORLD_PLACEHOLDER_TILE 0          // drawn where a chunk is still being generated
+#define CAMERA_MIN_ZOOM (1.f / 64.f)
+#define CAMERA_MAX_ZOOM 4.f
+#define CAMERA_ZOOM_STEP 1.1f             // zoom factor per mouse wheel notch
+#define CAMERA_PAN_SPEED 600.f            // screen pixels per second the arrow keys pan (x4 with SHIFT)
+#define CAMERA_SMOOTH true                // ease the camera towards where it is panned to, toggled with F
+#define CAMERA_FOLLOW_RATE 10.f           // per second, how quickly the eased camera closes the distance
+#define LOD_MIN_TILE_PIXELS 16.f          // tiles narrower than this on screen are drawn as 2x2, 4x4... blocks
+#define EDIT_TOOL EDIT_BRUSH              // what the left mouse button does to the map, cycled with E
+#define BRUSH_RADIUS 1                    // tiles around the picked one the brush paints, changed with [ and ]
+#define MAX_BRUSH_RADIUS 64
+#define EDIT_LOG_BUDGET (64 << 20)        // bytes of undo / redo history kept before the oldest edits are dropped
+#define VOXEL_LAYER_HEIGHT 0.25f          // of the tile height between stacked tiles, the thickness of the block in the tile art
+#define VOXEL_MAX_LAYERS 32               // tiles one column can stack, the map tile included
+#define VOXEL_HILLS 64                    // hills B raises anywhere on the map per press
+#define VOXEL_HILL_RADIUS 24              // largest hill radius in tiles, past the smallest of 3
 #define SHOW_TEXT true
+#define RENDER_MODE RENDER_IMMEDIATE      // how the tile field is submitted, cycled with M
+#define RETAIN_STATIC true                // draw a non-animating scene once and blit it afterwards
+#define OCCLUSION_CULLING false           // skip tiles nearer tiles cover completely, toggled with X, only repays its cost on hilly maps
+#define SHOW_PROFILER false               // per-phase frame timing overlay, toggled with P
+#define PROFILER_WINDOW 240               // frames the timing percentiles are taken over
+#define SOFTWARE_BAND_HEIGHT 32           // rows of the frame one worker rasterises at a time
+#define SOFTWARE_INCREMENTAL true         // redraw only the squares of the software frame where tiles changed, toggled with D
+
+#define BENCH_FRAMES 240                  // frames measured per benchmark configuration (--bench [frames])
+#define BENCH_WARMUP_FRAMES 10
+#define BENCH_TIME_STEP (1.0 / 60.0)      // simulated seconds per benchmark frame
+#define BENCH_GRID_SIZES {15, 50, 256, 1024, 4096}
+#define BENCH_OUTPUT "bench_results.csv"
+
+#define GOLDEN_DIR "golden"               // reference frames for --golden record|check
+#define GOLDEN_SEED 1234                  // tile map seed of every golden frame
+#define GOLDEN_TIME 1.25                  // simulated seconds the altitude functions are evaluated at
+#define GOLDEN_GRID_SIZES {15, 50, 256}
+#define GOLDEN_AMPLITUDES {0.f, 32.f, 160.f}
+#define GOLDEN_STDDEVS {0.5f, 1.5f, 3.f}  // within the 0 to 3 the controls allow
+#define GOLDEN_TOLERANCE 2                // per channel difference a pixel may have
+#define GOLDEN_MAX_MISMATCH 0             // pixels per frame allowed past the tolerance
+
+enum RenderMode
+{
+    RENDER_IMMEDIATE = 0, // one DrawTextureRec per tile, altitude on the CPU
+    RENDER_STATIC_GPU,    // static vertex buffer uploaded once, altitude in the vertex shader
+    RENDER_INSTANCED,     // one unit quad instanced per tile, altitude streamed from the CPU
+    RENDER_SORTED,        // tiles go through the radix-sorted draw list (stacks, overlays, sprites)
+    RENDER_SOFTWARE,      // rasterised into an Image on the CPU by the thread pool, works without a GPU
+    RENDER_MODE_COUNT
+};
+
+enum EditTool
+{
+    EDIT_BRUSH = 0, // paints a disc around the tile under the mouse while the button is held
+    EDIT_RECT,      // fills the rectangle between where the button went down and up
+    EDIT_FILL,      // flood fills the region of equal tiles that was clicked
+    EDIT_TOOL_COUNT
+};
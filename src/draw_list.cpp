@@ -0,0 +1,61 @@
+#include "draw_list.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+uint32_t isoDepthKey(int col, int row, int layer, int pass)
+{
+    // tiles on the same diagonal never overlap, everything further down the screen is drawn later
+    uint32_t diag = static_cast<uint32_t>(min(max(row + col, 0), (1 << DRAW_KEY_DIAG_BITS) - 1));
+    uint32_t lay = static_cast<uint32_t>(min(max(layer, 0), (1 << DRAW_KEY_LAYER_BITS) - 1));
+    uint32_t pas = static_cast<uint32_t>(min(max(pass, 0), (1 << DRAW_KEY_PASS_BITS) - 1));
+    return (diag << (DRAW_KEY_LAYER_BITS + DRAW_KEY_PASS_BITS)) | (lay << DRAW_KEY_PASS_BITS) | pas;
+}
+
+void clearDrawList(DrawList &list)
+{
+    list.entries.clear();
+    list.order.clear();
+}
+
+void pushDraw(DrawList &list, int col, int row, int layer, int pass, int tile, float altitude)
+{
+    uint32_t key = isoDepthKey(col, row, layer, pass);
+    list.order.push_back((uint64_t(key) << 32) | uint64_t(list.entries.size()));
+    list.entries.push_back({key, col, row, altitude, tile, false});
+}
+
+void sortDrawList(DrawList &list)
+{
+    size_t n = list.order.size();
+    if (n < 2)
+        return;
+    list.scratch.resize(n);
+
+    uint64_t *src = list.order.data();
+    uint64_t *dst = list.scratch.data();
+    for (int shift = 32; shift < 64; shift += 8) // one pass per key byte, least significant first
+    {
+        size_t counts[256] = {};
+        for (size_t i = 0; i < n; i++)
+            counts[(src[i] >> shift) & 0xff]++;
+
+        if (counts[(src[0] >> shift) & 0xff] == n)
+            continue; // every key shares this byte, the pass would not move anything
+
+        size_t offset = 0;
+        for (size_t &count : counts)
+        {
+            size_t c = count;
+            count = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; i++)
+            dst[counts[(src[i] >> shift) & 0xff]++] = src[i];
+        swap(src, dst);
+    }
+
+    if (src != list.order.data())
+        list.order.swap(list.scratch);
+}
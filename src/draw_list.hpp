@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Sprites collected during a frame and drawn back to front. Entries are ordered by a packed
+ * iso depth key with an LSD radix sort (O(n), stable), so stacked tiles and overlays
+ * mixed with the grid keep the right order without std::sort costs.
+ *
+ * key = [ row + col : 14 bits ][ layer : 10 bits ][ pass : 8 bits ]
+ */
+
+#define DRAW_KEY_DIAG_BITS 14
+#define DRAW_KEY_LAYER_BITS 10
+#define DRAW_KEY_PASS_BITS 8
+
+enum DrawPass
+{
+    DRAW_PASS_TILE = 0,     // regular tiles
+    DRAW_PASS_OVERLAY = 128 // outlines and highlights, drawn over the tile they belong to
+};
+
+struct DrawEntry
+{
+    uint32_t key;
+    int col;
+    int row;
+    float altitude; // vertical offset handed to drawTile()
+    int tile;
+    bool outline;   // held tiles only, the sorted list outlines with a DRAW_PASS_OVERLAY entry
+};
+
+struct DrawList
+{
+    std::vector<DrawEntry> entries;
+    std::vector<uint64_t> order;   // (key << 32 | entry index), sorted in place
+    std::vector<uint64_t> scratch; // ping-pong buffer of the radix passes
+};
+
+uint32_t isoDepthKey(int col, int row, int layer, int pass);
+void clearDrawList(DrawList &list);
+void pushDraw(DrawList &list, int col, int row, int layer, int pass, int tile, float altitude);
+void sortDrawList(DrawList &list); // afterwards list.order holds the entries back to front
+
+inline int drawPass(const DrawEntry &entry)
+{
+    return static_cast<int>(entry.key & ((1u << DRAW_KEY_PASS_BITS) - 1));
+}
+
+inline const DrawEntry &drawEntry(const DrawList &list, size_t i)
+{
+    return list.entries[static_cast<size_t>(list.order[i] & 0xffffffffu)];
+}
@@ -0,0 +1,403 @@
+#include "edit_log.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+using namespace std;
+
+static const size_t chunkTiles = TILE_CHUNK_SIZE * TILE_CHUNK_SIZE;
+
+void initEditLog(EditLog &log, size_t budgetBytes)
+{
+    log = {};
+    log.budgetBytes = budgetBytes;
+}
+
+void clearEditLog(EditLog &log)
+{
+    initEditLog(log, log.budgetBytes);
+}
+
+void beginEdit(EditLog &log)
+{
+    log.open = true;
+    for (size_t first : log.staged)
+        log.stagedCopy[first / chunkTiles] = SIZE_MAX;
+    log.staged.clear();
+    log.stagedTiles.clear();
+}
+
+// Copies the chunk holding `first` the first time the open edit touches it
+static void stageChunk(EditLog &log, const TileMap &map, size_t first)
+{
+    size_t chunk = first / chunkTiles;
+    if (chunk >= log.stagedCopy.size())
+        log.stagedCopy.resize(map.ids.size() / chunkTiles, SIZE_MAX); // follows the map as it grows
+    if (log.stagedCopy[chunk] != SIZE_MAX)
+        return;
+    log.stagedCopy[chunk] = log.stagedTiles.size();
+    log.staged.push_back(first);
+    log.stagedTiles.insert(log.stagedTiles.end(), map.ids.begin() + (ptrdiff_t)first, map.ids.begin() + (ptrdiff_t)(first + chunkTiles));
+}
+
+int paintTile(EditLog &log, TileMap &map, int col, int row, TileId id)
+{
+    if (col < 0 || row < 0 || col >= map.size || row >= map.size)
+        return 0;
+    size_t slot = tileSlot(col, row);
+    if (map.ids[slot] == id)
+        return 0;
+    stageChunk(log, map, chunkOffset(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT));
+    map.ids[slot] = id;
+    return 1;
+}
+
+int paintBrush(EditLog &log, TileMap &map, int col, int row, int radius, TileId id)
+{
+    int changed = 0;
+    for (int dy = -radius; dy <= radius; dy++)
+        for (int dx = -radius; dx <= radius; dx++)
+            if (dx * dx + dy * dy <= radius * radius)
+                changed += paintTile(log, map, col + dx, row + dy, id);
+    return changed;
+}
+
+int paintStroke(EditLog &log, TileMap &map, int fromCol, int fromRow, int toCol, int toRow, int radius, TileId id)
+{
+    // a dab on every cell of the line (Bresenham), dabs that overlap rewrite the same tiles and cost nothing in the diff
+    int dx = abs(toCol - fromCol), dy = -abs(toRow - fromRow);
+    int stepX = fromCol < toCol ? 1 : -1, stepY = fromRow < toRow ? 1 : -1;
+    int error = dx + dy;
+    int changed = 0;
+    for (;;)
+    {
+        changed += paintBrush(log, map, fromCol, fromRow, radius, id);
+        if (fromCol == toCol && fromRow == toRow)
+            return changed;
+        int doubled = 2 * error;
+        if (doubled >= dy)
+        {
+            error += dy;
+            fromCol += stepX;
+        }
+        if (doubled <= dx)
+        {
+            error += dx;
+            fromRow += stepY;
+        }
+    }
+}
+
+int paintRect(EditLog &log, TileMap &map, int col0, int row0, int col1, int row1, TileId id)
+{
+    int colBegin = max(min(col0, col1), 0), colEnd = min(max(col0, col1) + 1, map.size);
+    int rowBegin = max(min(row0, row1), 0), rowEnd = min(max(row0, row1) + 1, map.size);
+    if (colBegin >= colEnd || rowBegin >= rowEnd)
+        return 0;
+
+    // chunk by chunk, so each chunk is staged once and every row inside it is one contiguous fill
+    const int mask = TILE_CHUNK_SIZE - 1;
+    int chunks = (((colEnd - 1) >> TILE_CHUNK_SHIFT) - (colBegin >> TILE_CHUNK_SHIFT) + 1) *
+                 (((rowEnd - 1) >> TILE_CHUNK_SHIFT) - (rowBegin >> TILE_CHUNK_SHIFT) + 1);
+    log.stagedTiles.reserve(log.stagedTiles.size() + (size_t)chunks * chunkTiles); // one allocation instead of doubling through a full map
+    int changed = 0;
+    for (int chunkRow = rowBegin >> TILE_CHUNK_SHIFT; chunkRow <= (rowEnd - 1) >> TILE_CHUNK_SHIFT; chunkRow++)
+        for (int chunkCol = colBegin >> TILE_CHUNK_SHIFT; chunkCol <= (colEnd - 1) >> TILE_CHUNK_SHIFT; chunkCol++)
+        {
+            size_t first = chunkOffset(chunkCol, chunkRow);
+            stageChunk(log, map, first);
+            int left = max(colBegin, chunkCol << TILE_CHUNK_SHIFT) & mask;
+            int right = ((min(colEnd, (chunkCol + 1) << TILE_CHUNK_SHIFT) - 1) & mask) + 1;
+            int top = max(rowBegin, chunkRow << TILE_CHUNK_SHIFT);
+            int bottom = min(rowEnd, (chunkRow + 1) << TILE_CHUNK_SHIFT);
+            for (int row = top; row < bottom; row++)
+            {
+                TileId *tiles = map.ids.data() + first + (size_t)((row & mask) << TILE_CHUNK_SHIFT);
+                changed += (right - left) - (int)count(tiles + left, tiles + right, id);
+                fill(tiles + left, tiles + right, id);
+            }
+        }
+    return changed;
+}
+
+// First of tiles [from, to) that is not `value`, eight at a time
+static int skipForward(const TileId *tiles, int from, int to, TileId value)
+{
+    uint64_t pattern = 0x0101010101010101ULL * value;
+    uint64_t word;
+    while (from + 8 <= to && (memcpy(&word, tiles + from, 8), word == pattern))
+        from += 8;
+    while (from < to && tiles[from] == value)
+        from++;
+    return from;
+}
+
+// Last of tiles [from, to) that is not `value` plus one, from if there is none
+static int skipBackward(const TileId *tiles, int from, int to, TileId value)
+{
+    uint64_t pattern = 0x0101010101010101ULL * value;
+    uint64_t word;
+    while (to - 8 >= from && (memcpy(&word, tiles + to - 8, 8), word == pattern))
+        to -= 8;
+    while (to > from && tiles[to - 1] == value)
+        to--;
+    return to;
+}
+
+// First of [from, to) where a and b differ, to if they do not
+static size_t firstDifferent(const TileId *a, const TileId *b, size_t from, size_t to)
+{
+    while (from + 8 <= to && memcmp(a + from, b + from, 8) == 0)
+        from += 8;
+    while (from < to && a[from] == b[from])
+        from++;
+    return from;
+}
+
+// Last of [from, to) where a and b differ plus one, from if they do not
+static size_t lastDifferent(const TileId *a, const TileId *b, size_t from, size_t to)
+{
+    while (to >= from + 8 && memcmp(a + to - 8, b + to - 8, 8) == 0)
+        to -= 8;
+    while (to > from && a[to - 1] == b[to - 1])
+        to--;
+    return to;
+}
+
+// Row `row` of the chunk holding (col, row), indexed by col & (TILE_CHUNK_SIZE - 1)
+static TileId *chunkRowTiles(TileMap &map, int col, int row)
+{
+    return map.ids.data() + chunkOffset(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT) + (size_t)((row & (TILE_CHUNK_SIZE - 1)) << TILE_CHUNK_SHIFT);
+}
+
+// A tile of target floodFill() still has to paint the span of, found below or above a span it painted
+struct FloodSeed
+{
+    int col;
+    int row;
+    int parentRow; // row of the span that found it, filled over [parentLeft, parentRight]
+    int parentLeft;
+    int parentRight;
+};
+
+// Seeds the first tile of every span of target in tiles [left, right] of found.row, with found's parent
+static void seedSpans(vector<FloodSeed> &seeds, TileMap &map, FloodSeed found, int left, int right, TileId target)
+{
+    int row = found.row;
+    if (row < 0 || row >= map.size || left > right)
+        return;
+    const int mask = TILE_CHUNK_SIZE - 1;
+    bool inSpan = false;
+    for (int begin = left; begin <= right;)
+    {
+        int end = min(right + 1, (begin | mask) + 1);
+        const TileId *tiles = chunkRowTiles(map, begin, row) - (begin & ~mask); // indexed by col
+        for (int c = begin; c < end;)
+        {
+            const TileId *first = static_cast<const TileId *>(memchr(tiles + c, target, (size_t)(end - c)));
+            if (!first)
+            {
+                inSpan = false;
+                break;
+            }
+            if (first != tiles + c || !inSpan) // a span of target starts here
+            {
+                found.col = (int)(first - tiles);
+                seeds.push_back(found);
+            }
+            c = skipForward(tiles, (int)(first - tiles), end, target);
+            inSpan = c == end; // may go on in the next chunk
+        }
+        begin = end;
+    }
+}
+
+int floodFill(EditLog &log, TileMap &map, int col, int row, TileId id)
+{
+    if (col < 0 || row < 0 || col >= map.size || row >= map.size)
+        return 0;
+    const int mask = TILE_CHUNK_SIZE - 1;
+    TileId target = chunkRowTiles(map, col, row)[col & mask];
+    if (target == id)
+        return 0;
+
+    // scanline fill: paint the whole span of a seed's row, then seed each span of target in the rows above and below;
+    // spans are walked a chunk's row at a time, so every chunk is looked up and staged once per span, not per tile
+    int changed = 0;
+    vector<FloodSeed> seeds = {{col, row, -1, 0, -1}};
+    while (!seeds.empty())
+    {
+        FloodSeed seed = seeds.back();
+        seeds.pop_back();
+        int seedCol = seed.col, seedRow = seed.row;
+        if (chunkRowTiles(map, seedCol, seedRow)[seedCol & mask] != target)
+            continue;
+
+        int left = seedCol, right = seedCol;
+        while (left > 0)
+        {
+            const TileId *tiles = chunkRowTiles(map, left - 1, seedRow) - ((left - 1) & ~mask); // indexed by col
+            int chunkBegin = (left - 1) & ~mask;
+            left = skipBackward(tiles, chunkBegin, left, target);
+            if (left > chunkBegin)
+                break;
+        }
+        while (right < map.size - 1)
+        {
+            const TileId *tiles = chunkRowTiles(map, right + 1, seedRow) - ((right + 1) & ~mask);
+            int chunkEnd = min(((right + 1) | mask) + 1, map.size);
+            right = skipForward(tiles, right + 1, chunkEnd, target) - 1;
+            if (right < chunkEnd - 1)
+                break;
+        }
+        for (int begin = left; begin <= right;)
+        {
+            int end = min(right + 1, (begin | mask) + 1);
+            stageChunk(log, map, chunkOffset(begin >> TILE_CHUNK_SHIFT, seedRow >> TILE_CHUNK_SHIFT));
+            TileId *tiles = chunkRowTiles(map, begin, seedRow);
+            fill(tiles + (begin & mask), tiles + (begin & mask) + (end - begin), id);
+            changed += end - begin;
+            begin = end;
+        }
+
+        // the row the seed came from was filled over the parent's span, only the parts past it can hold target
+        for (int next : {seedRow - 1, seedRow + 1})
+        {
+            FloodSeed found = {0, next, seedRow, left, right};
+            if (next == seed.parentRow)
+            {
+                seedSpans(seeds, map, found, left, min(right, seed.parentLeft - 1), target);
+                seedSpans(seeds, map, found, max(left, seed.parentRight + 1), right, target);
+            }
+            else
+                seedSpans(seeds, map, found, left, right, target);
+        }
+    }
+    return changed;
+}
+
+// Appends one run. It joins the previous run when only tiles that already were `after` lie between them
+// (the ends of a fill over a varied map), so a fill stays a few runs however the old tiles were spread.
+static void pushRun(EditCommand &command, const TileId *ids, size_t slot, const TileId *before, size_t count, TileId after)
+{
+    bool repeat = all_of(before, before + count, [&](TileId tile)
+                         { return tile == before[0]; });
+    if (!command.runs.empty())
+    {
+        TileRun &last = command.runs.back();
+        size_t end = last.slot + last.count;
+        size_t gap = slot - end; // slots between are unchanged, so the map still holds their old tiles
+        if (last.after == after && gap <= chunkTiles && all_of(ids + end, ids + slot, [&](TileId tile)
+                                                              { return tile == after; }))
+        {
+            if (gap == 0 && repeat && last.literal == TILE_RUN_REPEAT && last.before == before[0])
+            {
+                last.count += (uint32_t)count;
+                return;
+            }
+            if (last.literal == TILE_RUN_REPEAT && last.count <= chunkTiles) // short enough to spell out
+            {
+                last.literal = (uint32_t)command.literals.size();
+                command.literals.insert(command.literals.end(), last.count, last.before);
+            }
+            if (last.literal != TILE_RUN_REPEAT) // its literals end the array, runs are appended in order
+            {
+                command.literals.insert(command.literals.end(), gap, after);
+                command.literals.insert(command.literals.end(), before, before + count);
+                last.count += (uint32_t)(gap + count);
+                return;
+            }
+        }
+    }
+
+    TileRun run = {(uint32_t)slot, (uint32_t)count, repeat ? TILE_RUN_REPEAT : (uint32_t)command.literals.size(), before[0], after};
+    if (!repeat)
+        command.literals.insert(command.literals.end(), before, before + count);
+    command.runs.push_back(run);
+}
+
+// Runs of one chunk: spans of changed tiles that were set to the same tile, unchanged tiles of that tile in between included
+static void diffChunk(EditCommand &command, const TileId *ids, size_t first, const TileId *before)
+{
+    // compared eight tiles at a time: a chunk the edit left alone or filled with one tile is a few hundred words
+    const TileId *after = ids + first;
+    size_t i = 0;
+    while (i < chunkTiles)
+    {
+        i = firstDifferent(before, after, i, chunkTiles);
+        if (i == chunkTiles)
+            break;
+        size_t end = (size_t)skipForward(after, (int)i + 1, (int)chunkTiles, after[i]); // tiles set to after[i]
+        size_t last = lastDifferent(before, after, i + 1, end);                          // past the last of them that changed
+        pushRun(command, ids, first + i, before + i, last - i, after[i]);
+        i = last;
+    }
+}
+
+static void dropUndo(EditLog &log)
+{
+    log.bytes -= editCommandBytes(log.undo.front());
+    log.undo.pop_front();
+}
+
+bool endEdit(EditLog &log, const TileMap &map)
+{
+    sort(log.staged.begin(), log.staged.end()); // ascending slots, so neighbouring chunks can join runs
+    EditCommand command;
+    command.literals.reserve(log.stagedTiles.size()); // the most it can hold; untouched pages cost nothing and it is trimmed below
+    for (size_t first : log.staged)
+        diffChunk(command, map.ids.data(), first, log.stagedTiles.data() + log.stagedCopy[first / chunkTiles]);
+    command.runs.shrink_to_fit();
+    command.literals.shrink_to_fit();
+
+    beginEdit(log); // drops the staged copies
+    log.open = false;
+    if (command.runs.empty())
+        return false;
+
+    for (const EditCommand &undone : log.redo)
+        log.bytes -= editCommandBytes(undone);
+    log.redo.clear(); // a new edit ends the redo history
+    log.bytes += editCommandBytes(command);
+    log.undo.push_back(move(command));
+    while (log.bytes > log.budgetBytes && log.undo.size() > 1)
+        dropUndo(log);
+    return true;
+}
+
+bool undoEdit(EditLog &log, TileMap &map)
+{
+    if (log.open || log.undo.empty())
+        return false;
+    EditCommand &command = log.undo.back();
+    for (const TileRun &run : command.runs)
+    {
+        TileId *tiles = map.ids.data() + run.slot;
+        if (run.literal == TILE_RUN_REPEAT)
+            fill_n(tiles, run.count, run.before);
+        else
+            copy_n(command.literals.data() + run.literal, run.count, tiles);
+    }
+    log.redo.push_back(move(command));
+    log.undo.pop_back();
+    return true;
+}
+
+bool redoEdit(EditLog &log, TileMap &map)
+{
+    if (log.open || log.redo.empty())
+        return false;
+    EditCommand &command = log.redo.back();
+    for (const TileRun &run : command.runs)
+        fill_n(map.ids.data() + run.slot, run.count, run.after);
+    log.undo.push_back(move(command));
+    log.redo.pop_back();
+    return true;
+}
+
+size_t editCommandBytes(const EditCommand &command)
+{
+    return sizeof(EditCommand) + command.runs.capacity() * sizeof(TileRun) + command.literals.capacity() * sizeof(TileId);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "tile_map.hpp"
+
+#define TILE_RUN_REPEAT UINT32_MAX // TileRun::literal of a run whose old tiles are all `before`
+
+// slots are stored in 32 bits, MAX_GRID_SIZE rounded up to whole chunks in Z-order must fit
+static_assert((uint64_t)MAX_GRID_SIZE * MAX_GRID_SIZE * 4 <= UINT32_MAX, "TileRun slots are too small for MAX_GRID_SIZE");
+
+/**
+ * Consecutive slots of the map (storage order, see tileSlot()) an edit set to one tile. The old
+ * tiles are either all `before` or kept in the command's literals. A run may cover slots that
+ * already held `after`, so filling over a varied map stays one run instead of one per changed tile.
+ */
+struct TileRun
+{
+    uint32_t slot;
+    uint32_t count;
+    uint32_t literal; // offset of the old tiles in EditCommand::literals, TILE_RUN_REPEAT when they are all `before`
+    TileId before;
+    TileId after;
+};
+
+// One undoable edit: a brush stroke, a rectangle or a flood fill
+struct EditCommand
+{
+    std::vector<TileRun> runs; // ascending, never overlapping
+    std::vector<TileId> literals;
+};
+
+/**
+ * Undo and redo stacks of run-length encoded diffs. The paint functions copy every chunk they
+ * touch before its first write; endEdit() diffs those copies against the map, so a stroke that
+ * crosses itself is still one command holding each tile once. Undo and redo set or copy whole
+ * runs, their cost is the memory they restore, not the number of tiles that changed.
+ */
+struct EditLog
+{
+    std::deque<EditCommand> undo;  // oldest first
+    std::vector<EditCommand> redo; // most recently undone last
+    size_t bytes;                  // held by both stacks
+    size_t budgetBytes;            // the oldest commands are dropped past this, the newest is always kept
+
+    bool open;                       // between beginEdit() and endEdit()
+    std::vector<size_t> staged;      // first slots of the chunks the edit touched
+    std::vector<size_t> stagedCopy;  // per chunk of the map (first slot / chunk tiles): offset of its copy in stagedTiles, SIZE_MAX if untouched
+    std::vector<TileId> stagedTiles; // chunks as they were before the edit
+};
+
+void initEditLog(EditLog &log, size_t budgetBytes);
+void clearEditLog(EditLog &log); // forgets every command, for a map generated anew
+void beginEdit(EditLog &log);
+bool endEdit(EditLog &log, const TileMap &map); // pushes what changed since beginEdit() as one command, false when nothing did
+
+// Writes between beginEdit() and endEdit(), clipped to the map; each returns the number of tiles it changed
+int paintTile(EditLog &log, TileMap &map, int col, int row, TileId id);
+int paintBrush(EditLog &log, TileMap &map, int col, int row, int radius, TileId id); // disc of the grid
+int paintStroke(EditLog &log, TileMap &map, int fromCol, int fromRow, int toCol, int toRow, int radius, TileId id); // brush along a line, no gaps when the mouse moves fast
+int paintRect(EditLog &log, TileMap &map, int col0, int row0, int col1, int row1, TileId id); // corners included, in any order
+int floodFill(EditLog &log, TileMap &map, int col, int row, TileId id);                       // 4-connected tiles equal to the one at (col, row)
+
+bool undoEdit(EditLog &log, TileMap &map); // false when there is nothing to undo or an edit is open
+bool redoEdit(EditLog &log, TileMap &map);
+size_t editCommandBytes(const EditCommand &command);
@@ -0,0 +1,41 @@
+#include "golden.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+FrameDiff compareFrames(const Image &expected, const Image &actual, int tolerance, Image *diff)
+{
+    FrameDiff result = {expected.width == actual.width && expected.height == actual.height, 0, 0};
+    if (!result.sizeMatches)
+        return result;
+
+    // work on RGBA8 copies so references saved in another format still compare
+    Image a = ImageCopy(expected);
+    Image b = ImageCopy(actual);
+    ImageFormat(&a, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    ImageFormat(&b, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    Color *pa = static_cast<Color *>(a.data);
+    Color *pb = static_cast<Color *>(b.data);
+    if (diff)
+        *diff = GenImageColor(a.width, a.height, BLACK);
+    Color *pd = diff ? static_cast<Color *>(diff->data) : nullptr;
+
+    size_t count = static_cast<size_t>(a.width) * static_cast<size_t>(a.height);
+    for (size_t i = 0; i < count; i++)
+    {
+        int delta = max(max(abs(pa[i].r - pb[i].r), abs(pa[i].g - pb[i].g)),
+                        max(abs(pa[i].b - pb[i].b), abs(pa[i].a - pb[i].a)));
+        result.maxDelta = max(result.maxDelta, delta);
+        bool bad = delta > tolerance;
+        if (bad)
+            result.mismatched++;
+        if (pd)
+            pd[i] = bad ? RED : Color{static_cast<unsigned char>(pb[i].r / 4), static_cast<unsigned char>(pb[i].g / 4), static_cast<unsigned char>(pb[i].b / 4), 255};
+    }
+
+    UnloadImage(a);
+    UnloadImage(b);
+    return result;
+}
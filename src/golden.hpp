@@ -0,0 +1,14 @@
+#pragma once
+
+#include <raylib.h>
+
+// Result of comparing a rendered frame against its reference
+struct FrameDiff
+{
+    bool sizeMatches;
+    int mismatched; // pixels with a channel further off than the tolerance
+    int maxDelta;   // largest channel difference seen
+};
+
+// Compares two frames channel by channel, `diff` (optional) gets mismatched pixels in red over a dimmed copy of `actual`
+FrameDiff compareFrames(const Image &expected, const Image &actual, int tolerance, Image *diff = nullptr);
@@ -0,0 +1,378 @@
+#include "gpu_grid.hpp"
+
+#include <raymath.h>
+#include <rlgl.h>
+
+#include <cstddef>
+#include <string>
+
+#include "stats.hpp"
+
+using namespace std;
+
+#ifndef RL_UNSIGNED_SHORT
+#define RL_UNSIGNED_SHORT 0x1403 // GL_UNSIGNED_SHORT, not part of rlgl.h
+#endif
+
+// One vertex of a tile quad, 8 bytes
+struct GridVertex
+{
+    unsigned short row;
+    unsigned short col;
+    unsigned short tile;
+    unsigned short corner; // 0: top left, 1: top right, 2: bottom left, 3: bottom right
+};
+
+static const unsigned short quadCorners[6] = {0, 2, 3, 0, 3, 1}; // two triangles, same winding as rlgl quads
+
+// Shared by both paths: uniforms and the placement drawTile() does on the CPU
+static const char *tileShaderHeader = R"(#version 330
+uniform mat4 mvp;
+uniform vec2 startPos;
+uniform vec2 tileSize; // grid spacing, tileScale times the atlas tile size
+uniform float tileScale;
+uniform float gridSize;
+uniform vec4 tileRects[TILE_COUNT]; // source rectangles inside the atlas
+uniform vec2 atlasSize;
+out vec2 fragTexCoord;
+
+void placeTile(float row, float col, float tile, float corner, float altitude)
+{
+    vec2 iso = vec2(col * tileSize.x - row * tileSize.y, 0.5 * (col * tileSize.x + row * tileSize.y));
+    vec2 pos = startPos + iso / 2.0 - vec2(floor(tileSize.x / 2.0), floor(tileSize.y * gridSize / 4.0));
+    pos.y -= altitude;
+    pos = trunc(pos);
+
+    vec2 offset = vec2(mod(corner, 2.0), floor(corner / 2.0));
+    vec4 rect = tileRects[int(tile)];
+    fragTexCoord = (rect.xy + offset * rect.zw) / atlasSize;
+    gl_Position = mvp * vec4(pos + offset * rect.zw * tileScale, 0.0, 1.0);
+}
+)";
+
+static const char *staticGridVertexShader = R"(
+in vec4 gridVertex; // row, col, tile id, corner
+uniform float time;
+uniform float oscilSpeed;
+uniform float amplitude;
+uniform int oscilOption;
+
+void main()
+{
+    float row = gridVertex.x;
+    float col = gridVertex.y;
+    float t = time * oscilSpeed;
+
+    // same options as altitudeAt()
+    float altitude;
+    if (oscilOption == 1)
+        altitude = sin(row + t) * amplitude; // along row
+    else if (oscilOption == 2)
+        altitude = sin(col + t) * amplitude; // along col
+    else
+        altitude = sin(row + t) * sin(col + t) * amplitude; // along both
+
+    placeTile(row, col, gridVertex.z, gridVertex.w, altitude);
+}
+)";
+
+static const char *instancedVertexShader = R"(
+in float quadCorner;
+in vec3 tileInstance; // col, row, tile id (per instance)
+in float tileAltitude; // per instance
+
+void main()
+{
+    placeTile(tileInstance.y, tileInstance.x, tileInstance.z, quadCorner, tileAltitude);
+}
+)";
+
+static const char *tileFragmentShader = R"(#version 330
+in vec2 fragTexCoord;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+out vec4 finalColor;
+
+void main()
+{
+    finalColor = texture(texture0, fragTexCoord) * colDiffuse;
+}
+)";
+
+static bool loadTileShader(TileShader &shader, const char *vertexMain)
+{
+    shader = {};
+#if defined(PLATFORM_WEB)
+    (void)vertexMain;
+    return false; // GLES2 has no trunc() or instancing without extensions, keep the immediate path there
+#else
+    string vsCode = string(tileShaderHeader) + vertexMain;
+    vsCode.insert(vsCode.find('\n') + 1, "#define TILE_COUNT " + to_string(IMG_ARRAY_SIZE) + "\n");
+
+    shader.id = rlLoadShaderCode(vsCode.c_str(), tileFragmentShader);
+    if (shader.id == 0 || shader.id == rlGetShaderIdDefault())
+    {
+        shader.id = 0;
+        return false;
+    }
+
+    shader.locMvp = rlGetLocationUniform(shader.id, "mvp");
+    shader.locStartPos = rlGetLocationUniform(shader.id, "startPos");
+    shader.locTileSize = rlGetLocationUniform(shader.id, "tileSize");
+    shader.locTileScale = rlGetLocationUniform(shader.id, "tileScale");
+    shader.locGridSize = rlGetLocationUniform(shader.id, "gridSize");
+    shader.locTileRects = rlGetLocationUniform(shader.id, "tileRects");
+    shader.locAtlasSize = rlGetLocationUniform(shader.id, "atlasSize");
+    shader.locTexture = rlGetLocationUniform(shader.id, "texture0");
+    shader.locTint = rlGetLocationUniform(shader.id, "colDiffuse");
+    return true;
+#endif
+}
+
+static void unloadTileShader(TileShader &shader)
+{
+    if (shader.id)
+        rlUnloadShaderProgram(shader.id);
+    shader = {};
+}
+
+// Flushes rlgl, binds the shader and atlas and sets the shared uniforms, lod > 1 draws a grid of lod x lod blocks
+static void beginTileShader(const TileShader &shader, const TileAtlas &atlas, Vector2 startPos, int gridSize, int lod, Color tint)
+{
+    rlDrawRenderBatchActive(); // whatever rlgl has batched so far must land below the grid
+    countFlush();
+
+    float tileSize[2] = {(float)(atlas.tileWidth * lod), (float)(atlas.tileHeight * lod)};
+    float tileScale = (float)lod;
+    float atlasSize[2] = {(float)atlas.texture.width, (float)atlas.texture.height};
+    float size = (float)gridSize;
+    float tileRects[IMG_ARRAY_SIZE * 4] = {};
+    for (int i = 0; i < atlas.count; i++)
+    {
+        tileRects[i * 4 + 0] = atlas.rects[i].x;
+        tileRects[i * 4 + 1] = atlas.rects[i].y;
+        tileRects[i * 4 + 2] = atlas.rects[i].width;
+        tileRects[i * 4 + 3] = atlas.rects[i].height;
+    }
+    float tintValue[4] = {tint.r / 255.f, tint.g / 255.f, tint.b / 255.f, tint.a / 255.f};
+    int textureSlot = 0;
+
+    rlEnableShader(shader.id);
+    rlSetUniformMatrix(shader.locMvp, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    rlSetUniform(shader.locStartPos, &startPos, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(shader.locTileSize, tileSize, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(shader.locTileScale, &tileScale, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(shader.locGridSize, &size, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(shader.locTileRects, tileRects, RL_SHADER_UNIFORM_VEC4, IMG_ARRAY_SIZE);
+    rlSetUniform(shader.locAtlasSize, atlasSize, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(shader.locTint, tintValue, RL_SHADER_UNIFORM_VEC4, 1);
+    rlSetUniform(shader.locTexture, &textureSlot, RL_SHADER_UNIFORM_INT, 1);
+
+    rlActiveTextureSlot(0);
+    rlEnableTexture(atlas.texture.id);
+}
+
+static void endTileShader()
+{
+    rlDisableVertexArray();
+    rlDisableTexture();
+    rlDisableShader();
+}
+
+bool loadGpuGrid(GpuGrid &grid)
+{
+    grid = {};
+    if (!loadTileShader(grid.shader, staticGridVertexShader))
+        return false;
+
+    grid.locVertex = rlGetLocationAttrib(grid.shader.id, "gridVertex");
+    grid.locTime = rlGetLocationUniform(grid.shader.id, "time");
+    grid.locOscilSpeed = rlGetLocationUniform(grid.shader.id, "oscilSpeed");
+    grid.locAmplitude = rlGetLocationUniform(grid.shader.id, "amplitude");
+    grid.locOscilOption = rlGetLocationUniform(grid.shader.id, "oscilOption");
+
+    grid.vaoId = rlLoadVertexArray();
+    grid.ready = grid.locVertex >= 0 && grid.vaoId != 0;
+    if (!grid.ready)
+        unloadGpuGrid(grid);
+    return grid.ready;
+}
+
+void unloadGpuGrid(GpuGrid &grid)
+{
+    if (grid.vboId)
+        rlUnloadVertexBuffer(grid.vboId);
+    if (grid.vaoId)
+        rlUnloadVertexArray(grid.vaoId);
+    unloadTileShader(grid.shader);
+    grid = {};
+}
+
+void updateGpuGrid(GpuGrid &grid, const TileMap &tileMap, unsigned int tileMapVersion)
+{
+    int gridSize = tileMap.size;
+    if (!grid.ready || (grid.vboId && grid.gridSize == gridSize && grid.tileMapVersion == tileMapVersion))
+        return;
+
+    // rows and columns in the same order drawTiles() walks them, so the painter's order is kept inside the single draw call
+    vector<GridVertex> vertices;
+    vertices.reserve(static_cast<size_t>(gridSize) * static_cast<size_t>(gridSize) * 6);
+    for (int row = 0; row < gridSize; row++)
+    {
+        for (int col = 0; col < gridSize; col++)
+        {
+            unsigned short tile = static_cast<unsigned short>(tileAt(tileMap, col, row));
+            for (unsigned short corner : quadCorners)
+                vertices.push_back({static_cast<unsigned short>(row), static_cast<unsigned short>(col), tile, corner});
+        }
+    }
+
+    rlEnableVertexArray(grid.vaoId);
+    if (grid.vboId)
+        rlUnloadVertexBuffer(grid.vboId);
+    grid.vboId = rlLoadVertexBuffer(vertices.data(), static_cast<int>(vertices.size() * sizeof(GridVertex)), false);
+    rlSetVertexAttribute(static_cast<unsigned int>(grid.locVertex), 4, RL_UNSIGNED_SHORT, false, sizeof(GridVertex), 0);
+    rlEnableVertexAttribute(static_cast<unsigned int>(grid.locVertex));
+    rlDisableVertexArray();
+
+    grid.vertexCount = static_cast<int>(vertices.size());
+    grid.gridSize = gridSize;
+    grid.tileMapVersion = tileMapVersion;
+}
+
+void drawGpuGrid(GpuGrid &grid, const TileAtlas &atlas, const VisibleTiles &visible, Vector2 startPos, float time, float oscilSpeed, float amplitude, int oscilOption, Color tint)
+{
+    if (!grid.ready || !grid.vboId)
+        return;
+
+    int colBegin, colEnd;
+    beginTileShader(grid.shader, atlas, startPos, grid.gridSize, 1, tint);
+    rlSetUniform(grid.locTime, &time, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(grid.locOscilSpeed, &oscilSpeed, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(grid.locAmplitude, &amplitude, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(grid.locOscilOption, &oscilOption, RL_SHADER_UNIFORM_INT, 1);
+
+    rlEnableVertexArray(grid.vaoId);
+
+    // the buffer is row-major, so every visible row is one contiguous range; ranges that touch are merged
+    int first = 0;
+    int count = 0;
+    for (int row = visible.rowBegin; row < visible.rowEnd; row++)
+    {
+        if (!visibleCols(visible, row, colBegin, colEnd))
+            continue;
+
+        int rowFirst = (row * grid.gridSize + colBegin) * 6;
+        if (count > 0 && first + count != rowFirst)
+        {
+            rlDrawVertexArray(first, count);
+            countDirectDraw(count);
+            count = 0;
+        }
+        if (count == 0)
+            first = rowFirst;
+        count += (colEnd - colBegin) * 6;
+    }
+    if (count > 0)
+    {
+        rlDrawVertexArray(first, count); // a grid that fits on screen ends up here as a single call
+        countDirectDraw(count);
+    }
+    endTileShader();
+}
+
+bool loadInstancedGrid(InstancedGrid &grid)
+{
+    grid = {};
+    if (!loadTileShader(grid.shader, instancedVertexShader))
+        return false;
+
+    grid.locCorner = rlGetLocationAttrib(grid.shader.id, "quadCorner");
+    grid.locInstance = rlGetLocationAttrib(grid.shader.id, "tileInstance");
+    grid.locAltitude = rlGetLocationAttrib(grid.shader.id, "tileAltitude");
+    if (grid.locCorner < 0 || grid.locInstance < 0 || grid.locAltitude < 0)
+    {
+        unloadInstancedGrid(grid);
+        return false;
+    }
+
+    float corners[6];
+    for (int i = 0; i < 6; i++)
+        corners[i] = quadCorners[i];
+
+    grid.vaoId = rlLoadVertexArray();
+    if (!grid.vaoId)
+    {
+        unloadInstancedGrid(grid);
+        return false;
+    }
+    rlEnableVertexArray(grid.vaoId);
+    grid.quadVboId = rlLoadVertexBuffer(corners, sizeof(corners), false);
+    rlSetVertexAttribute(static_cast<unsigned int>(grid.locCorner), 1, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(static_cast<unsigned int>(grid.locCorner));
+    rlDisableVertexArray();
+
+    grid.ready = true;
+    return true;
+}
+
+void unloadInstancedGrid(InstancedGrid &grid)
+{
+    if (grid.instanceVboId)
+        rlUnloadVertexBuffer(grid.instanceVboId);
+    if (grid.quadVboId)
+        rlUnloadVertexBuffer(grid.quadVboId);
+    if (grid.vaoId)
+        rlUnloadVertexArray(grid.vaoId);
+    unloadTileShader(grid.shader);
+    grid = {};
+}
+
+void pushTileInstance(InstancedGrid &grid, int col, int row, int tile, float altitude)
+{
+    grid.instances.push_back({static_cast<unsigned short>(col),
+                              static_cast<unsigned short>(row),
+                              static_cast<unsigned short>(tile),
+                              0,
+                              altitude});
+}
+
+void drawInstancedGrid(InstancedGrid &grid, const TileAtlas &atlas, Vector2 startPos, int gridSize, int lod, Color tint)
+{
+    int count = static_cast<int>(grid.instances.size());
+    if (!grid.ready || count == 0)
+    {
+        grid.instances.clear();
+        return;
+    }
+
+    rlEnableVertexArray(grid.vaoId);
+    int bytes = count * static_cast<int>(sizeof(TileInstance));
+    if (count > grid.instanceCapacity)
+    {
+        // grow geometrically so resizing the grid does not reallocate every step
+        if (grid.instanceVboId)
+            rlUnloadVertexBuffer(grid.instanceVboId);
+        grid.instanceCapacity = max(count, grid.instanceCapacity * 2);
+        grid.instanceVboId = rlLoadVertexBuffer(nullptr, grid.instanceCapacity * static_cast<int>(sizeof(TileInstance)), true);
+
+        unsigned int instanceLoc = static_cast<unsigned int>(grid.locInstance);
+        unsigned int altitudeLoc = static_cast<unsigned int>(grid.locAltitude);
+        rlSetVertexAttribute(instanceLoc, 3, RL_UNSIGNED_SHORT, false, sizeof(TileInstance), 0);
+        rlSetVertexAttributeDivisor(instanceLoc, 1);
+        rlEnableVertexAttribute(instanceLoc);
+        rlSetVertexAttribute(altitudeLoc, 1, RL_FLOAT, false, sizeof(TileInstance), offsetof(TileInstance, altitude));
+        rlSetVertexAttributeDivisor(altitudeLoc, 1);
+        rlEnableVertexAttribute(altitudeLoc);
+    }
+    rlUpdateVertexBuffer(grid.instanceVboId, grid.instances.data(), bytes, 0); // the only per-frame upload
+    rlDisableVertexArray();
+
+    beginTileShader(grid.shader, atlas, startPos, gridSize, lod, tint);
+    rlEnableVertexArray(grid.vaoId);
+    rlDrawVertexArrayInstanced(0, 6, count);
+    endTileShader();
+
+    countDirectDraw(6 * count);
+    grid.instances.clear();
+}
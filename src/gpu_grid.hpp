@@ -0,0 +1,79 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <vector>
+
+#include "atlas.hpp"
+#include "iso.hpp"
+#include "tile_map.hpp"
+
+// Shader program plus the uniforms both GPU tile paths share
+struct TileShader
+{
+    unsigned int id;
+    int locMvp;
+    int locStartPos;
+    int locTileSize;
+    int locTileScale;
+    int locGridSize;
+    int locTileRects;
+    int locAtlasSize;
+    int locTexture;
+    int locTint;
+};
+
+// Tile grid uploaded once as a static vertex buffer, altitude is evaluated in the vertex shader
+struct GpuGrid
+{
+    TileShader shader;
+    unsigned int vaoId;
+    unsigned int vboId;
+    int vertexCount;
+    int gridSize;                // grid the buffer was built for
+    unsigned int tileMapVersion; // tileMap revision the buffer was built from
+    bool ready;                  // false when the shader could not be compiled (e.g. GLES2)
+
+    int locVertex;
+    int locTime;
+    int locOscilSpeed;
+    int locAmplitude;
+    int locOscilOption;
+};
+
+// Per-instance data streamed every frame, 12 bytes per tile
+struct TileInstance
+{
+    unsigned short col;
+    unsigned short row;
+    unsigned short tile;
+    unsigned short reserved;
+    float altitude; // read from the CPU altitude field, so custom patterns keep working
+};
+
+// One unit quad drawn once per tile, fed by a TileInstance buffer
+struct InstancedGrid
+{
+    TileShader shader;
+    unsigned int vaoId;
+    unsigned int quadVboId;
+    unsigned int instanceVboId;
+    int instanceCapacity; // instances the GPU buffer can hold before it is reallocated
+    bool ready;
+
+    int locCorner;
+    int locInstance;
+    int locAltitude;
+
+    std::vector<TileInstance> instances; // filled by drawGame() each frame
+};
+
+bool loadGpuGrid(GpuGrid &grid);
+void unloadGpuGrid(GpuGrid &grid);
+void updateGpuGrid(GpuGrid &grid, const TileMap &tileMap, unsigned int tileMapVersion); // rebuilds only if grid or map changed
+void drawGpuGrid(GpuGrid &grid, const TileAtlas &atlas, const VisibleTiles &visible, Vector2 startPos, float time, float oscilSpeed, float amplitude, int oscilOption, Color tint);
+
+bool loadInstancedGrid(InstancedGrid &grid);
+void unloadInstancedGrid(InstancedGrid &grid);
+void pushTileInstance(InstancedGrid &grid, int col, int row, int tile, float altitude);
+void drawInstancedGrid(InstancedGrid &grid, const TileAtlas &atlas, Vector2 startPos, int gridSize, int lod, Color tint); // uploads and clears the instances, col/row of lod x lod blocks
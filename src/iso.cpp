@@ -0,0 +1,191 @@
+#include "iso.hpp"
+
+#include <raymath.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+Vector2 transform(Vector2 v)
+{
+    /**
+    * Apply matrix transformation
+    * M = [+1.0 -1.0]
+    *     [+0.5 +0.5]
+
+    * v = <x, y>
+
+    * v' = Mv
+     */
+
+    return {1.0f * v.x - 1.0f * v.y,
+            0.5f * v.x + 0.5f * v.y};
+}
+
+Vector2 inverseTransform(Vector2 v)
+{
+    /**
+    * Undo transform()
+    * M^-1 = [+0.5 +1.0]
+    *        [-0.5 +1.0]
+     */
+
+    return {0.5f * v.x + 1.0f * v.y,
+            -0.5f * v.x + 1.0f * v.y};
+}
+
+Vector2 tileScreenPosition(int col, int row, int tileWidth, int tileHeight, Vector2 startPos, int size, float altitude)
+{
+    Vector2 isoCoords = transform({float(col * tileWidth), float(row * tileHeight)}); // isometric transformation
+    isoCoords.x = startPos.x + (isoCoords.x / 2.f) - (float)(tileWidth / 2);
+    isoCoords.y = startPos.y + (isoCoords.y / 2.f) - (float)(tileHeight * size / 4);
+
+    isoCoords.y -= altitude; // Makes the tile appear elevated
+    return isoCoords;
+}
+
+VisibleTiles visibleTiles(Vector2 startPos, int size, int tileWidth, int tileHeight, Rectangle view, float maxAltitude)
+{
+    /**
+     * drawTile() puts a tile at startPos + transform(col * tileW, row * tileH) / 2 minus a fixed offset,
+     * then lifts it by its altitude. Solving that for the view rectangle (grown by one tile and
+     * by maxAltitude on both vertical sides) gives a rectangle in transform() space; its inverse
+     * is the parallelogram of grid cells that may touch the view.
+     */
+    float tileW = (float)tileWidth;
+    float tileH = (float)tileHeight;
+    float offsetX = (float)(tileWidth / 2);
+    float offsetY = (float)(tileHeight * size / 4);
+
+    VisibleTiles visible;
+    visible.size = size;
+    visible.tileWidth = tileWidth;
+    visible.tileHeight = tileHeight;
+    visible.isoMin = {2.f * (view.x - tileW - startPos.x + offsetX),
+                      2.f * (view.y - tileH - startPos.y + offsetY - maxAltitude)};
+    visible.isoMax = {2.f * (view.x + view.width - startPos.x + offsetX),
+                      2.f * (view.y + view.height - startPos.y + offsetY + maxAltitude)};
+
+    // rows are bounded by the extreme corners of the parallelogram
+    float rowMin = inverseTransform({visible.isoMax.x, visible.isoMin.y}).y / tileH;
+    float rowMax = inverseTransform({visible.isoMin.x, visible.isoMax.y}).y / tileH;
+    visible.rowBegin = static_cast<int>(Clamp(floorf(rowMin), 0.f, (float)size));
+    visible.rowEnd = static_cast<int>(Clamp(floorf(rowMax) + 1.f, 0.f, (float)size));
+    return visible;
+}
+
+bool visibleCols(const VisibleTiles &visible, int row, int &colBegin, int &colEnd)
+{
+    // col * tileW must keep transform().x inside [isoMin.x, isoMax.x] and transform().y inside [isoMin.y, isoMax.y]
+    float tileW = (float)visible.tileWidth;
+    float rowH = (float)(row * visible.tileHeight);
+    float lo = max(visible.isoMin.x + rowH, 2.f * visible.isoMin.y - rowH) / tileW;
+    float hi = min(visible.isoMax.x + rowH, 2.f * visible.isoMax.y - rowH) / tileW;
+
+    colBegin = static_cast<int>(Clamp(floorf(lo), 0.f, (float)visible.size));
+    colEnd = static_cast<int>(Clamp(floorf(hi) + 1.f, 0.f, (float)visible.size));
+    return colBegin < colEnd;
+}
+
+int visibleChunkRows(const VisibleTiles &visible, int &chunkRowBegin)
+{
+    chunkRowBegin = visible.rowBegin >> TILE_CHUNK_SHIFT;
+    if (visible.rowBegin >= visible.rowEnd)
+        return 0;
+    return ((visible.rowEnd - 1) >> TILE_CHUNK_SHIFT) - chunkRowBegin + 1;
+}
+
+bool visibleChunkBand(const VisibleTiles &visible, int chunkRow, ChunkBand &band)
+{
+    band.chunkRow = chunkRow;
+    band.rowBegin = max(visible.rowBegin, chunkRow << TILE_CHUNK_SHIFT);
+    band.rowEnd = min(visible.rowEnd, (chunkRow + 1) << TILE_CHUNK_SHIFT);
+
+    int colMin = visible.size, colMax = 0;
+    for (int row = band.rowBegin; row < band.rowEnd; row++)
+    {
+        int i = row - band.rowBegin;
+        if (!visibleCols(visible, row, band.colBegin[i], band.colEnd[i]))
+        {
+            band.colBegin[i] = band.colEnd[i] = 0;
+            continue;
+        }
+        colMin = min(colMin, band.colBegin[i]);
+        colMax = max(colMax, band.colEnd[i]);
+    }
+    if (colMin >= colMax)
+        return false;
+    band.chunkColBegin = colMin >> TILE_CHUNK_SHIFT;
+    band.chunkColEnd = ((colMax - 1) >> TILE_CHUNK_SHIFT) + 1;
+    return true;
+}
+
+Vector2 tileCell(Vector2 point, Vector2 startPos, int size, int tileWidth, int tileHeight)
+{
+    // undoes tileScreenPosition() at altitude 0, measured from the top corner of tile (0, 0)
+    Vector2 iso = {2.f * (point.x - startPos.x + (float)(tileWidth / 2)) - (float)tileWidth,
+                   2.f * (point.y - startPos.y + (float)(tileHeight * size / 4))};
+    Vector2 cell = inverseTransform(iso);
+    return {cell.x / (float)tileWidth, cell.y / (float)tileHeight};
+}
+
+bool pickTile(Vector2 point, Vector2 startPos, int size, int tileWidth, int tileHeight, float minAltitude, float maxAltitude,
+              const std::function<float(int col, int row)> &altitude, const std::function<float(int col, int row)> &depth, int &col, int &row)
+{
+    /**
+     * The tile art is a block: its top face is the diamond of the cell, a quarter of the tile height
+     * down the sprite, and its side faces hang another quarter below it. A tile lifted by a covers point
+     * with its top face if point + (0, a - tileHeight / 4) falls in its cell on the flat plane, and with
+     * its sides, or those of the tiles stacked under it down to depth below, if point + (0, a - tileHeight / 4 - d)
+     * does for some d up to tileHeight / 4 + depth. With every altitude and a - depth in [minAltitude, maxAltitude]
+     * the candidates are the cells the vertical segment from point + (0, minAltitude - tileHeight / 2) to
+     * point + (0, maxAltitude - tileHeight / 4) crosses: a diagonal line in cell space, walked from its lower
+     * (front) end up so the first tile that holds point is the one drawn on top. The walk is as long as
+     * the altitude range, not the grid.
+     */
+    float faceTop = (float)tileHeight / 4.f;
+    Vector2 front = tileCell({point.x, point.y + maxAltitude - faceTop}, startPos, size, tileWidth, tileHeight);
+    Vector2 back = tileCell({point.x, point.y + minAltitude - 2.f * faceTop}, startPos, size, tileWidth, tileHeight);
+    int c = (int)floorf(front.x);
+    int r = (int)floorf(front.y);
+    float fracCol = front.x - (float)c; // where the line is inside the current cell
+    float fracRow = front.y - (float)r;
+    float backDiagonal = back.x + back.y;
+
+    while ((float)(c + r + 2) > backDiagonal) // the cell still reaches down to the back end of the segment
+    {
+        if (c >= 0 && r >= 0 && c < size && r < size)
+        {
+            // moving point up by d moves its cell by t = 2d / tileHeight back along both axes, the faces
+            // cover it if a t from 0 (the top face) to the bottom of the sides keeps it inside the cell
+            Vector2 cell = tileCell({point.x, point.y + altitude(c, r) - faceTop}, startPos, size, tileWidth, tileHeight);
+            float first = max({0.f, cell.x - (float)(c + 1), cell.y - (float)(r + 1)});
+            float last = min({0.5f + 2.f * depth(c, r) / (float)tileHeight, cell.x - (float)c, cell.y - (float)r});
+            if (first <= last)
+            {
+                col = c;
+                row = r;
+                return true;
+            }
+        }
+
+        // going up the screen col and row drop at 1 / tileWidth and 1 / tileHeight per iso unit,
+        // the line leaves the cell through whichever edge it reaches first
+        float toCol = fracCol * (float)tileWidth;
+        float toRow = fracRow * (float)tileHeight;
+        if (toCol < toRow)
+        {
+            c--;
+            fracRow -= toCol / (float)tileHeight;
+            fracCol = 1.f;
+        }
+        else
+        {
+            r--;
+            fracCol -= toRow / (float)tileWidth;
+            fracRow = 1.f;
+        }
+    }
+    return false;
+}
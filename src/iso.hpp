@@ -0,0 +1,58 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <functional>
+
+#include "definitions.hpp"
+
+// Part of the grid that can reach the screen, see visibleTiles()
+struct VisibleTiles
+{
+    int rowBegin; // visible rows [rowBegin, rowEnd)
+    int rowEnd;
+    int size;     // grid size the range was computed for
+    int tileWidth;
+    int tileHeight;
+    Vector2 isoMin; // screen rectangle (padded by tile size and amplitude) in transform() space
+    Vector2 isoMax;
+};
+
+// Grid a frame draws the map as: zoomed out, each lod x lod block of tiles is one tile lod times the size
+struct FieldLayout
+{
+    Vector2 startPos;      // of the grid drawn
+    int size;              // tiles per side of the map drawn
+    int lod;
+    int blocks;            // tiles per side of the grid drawn, ceil(size / lod)
+    float stackHeight;     // pixels stacked tiles rise above the altitude
+    VisibleTiles visible;  // of the grid drawn
+};
+
+/**
+ * Visible part of one row of tile chunks. Walking bands top to bottom, their chunks left to right
+ * and each chunk row-major is still back to front: tiles that swap order against plain row-major
+ * are at least two columns apart on screen and never overlap.
+ */
+struct ChunkBand
+{
+    int chunkRow;
+    int rowBegin; // visible rows [rowBegin, rowEnd) of the band
+    int rowEnd;
+    int colBegin[TILE_CHUNK_SIZE]; // visible columns of row rowBegin + i, empty when colBegin >= colEnd
+    int colEnd[TILE_CHUNK_SIZE];
+    int chunkColBegin; // chunks [chunkColBegin, chunkColEnd) hold at least one visible tile of the band
+    int chunkColEnd;
+};
+
+Vector2 transform(Vector2 v);
+Vector2 inverseTransform(Vector2 v);
+Vector2 tileScreenPosition(int col, int row, int tileWidth, int tileHeight, Vector2 startPos, int size, float altitude); // top left of the tile sprite
+VisibleTiles visibleTiles(Vector2 startPos, int size, int tileWidth, int tileHeight, Rectangle view, float maxAltitude);
+bool visibleCols(const VisibleTiles &visible, int row, int &colBegin, int &colEnd); // visible columns [colBegin, colEnd) of a row
+int visibleChunkRows(const VisibleTiles &visible, int &chunkRowBegin);           // number of chunk rows from chunkRowBegin on
+bool visibleChunkBand(const VisibleTiles &visible, int chunkRow, ChunkBand &band); // false if nothing of the band is visible
+Vector2 tileCell(Vector2 point, Vector2 startPos, int size, int tileWidth, int tileHeight);       // (col, row) of a point on the altitude 0 plane, floor() is the tile whose top face holds it
+bool pickTile(Vector2 point, Vector2 startPos, int size, int tileWidth, int tileHeight, float minAltitude, float maxAltitude,
+              const std::function<float(int col, int row)> &altitude, const std::function<float(int col, int row)> &depth,
+              int &col, int &row); // frontmost tile whose top or side faces are drawn over point, altitude of its top face, depth of the tiles under it
@@ -2,12 +2,35 @@
 
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
 
 #include <string>
 #include <vector>
-#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <utility>
 
 #include "definitions.hpp" // Contains constants relevent to program
+#include "atlas.hpp"
+#include "stats.hpp"
+#include "gpu_grid.hpp"
+#include "iso.hpp"
+#include "altitude.hpp"
+#include "render_cache.hpp"
+#include "draw_list.hpp"
+#include "profiler.hpp"
+#include "software_renderer.hpp"
+#include "thread_pool.hpp"
+#include "golden.hpp"
+#include "random.hpp"
+#include "tile_map.hpp"
+#include "world.hpp"
+#include "view_camera.hpp"
+#include "edit_log.hpp"
+#include "voxel_stacks.hpp"
+#include "occlusion.hpp"
 using namespace std;
 
 // Globals
@@ -23,6 +46,9 @@ int gridSize = GRID_SIZE; // square grid
 float amplitude = AMPLITUDE;
 float oscilSpeed = OSCIl_SPEED;
 unsigned short oscilOption = OSCIL_OPTION; // for different altitude functions
+RenderMode renderMode = RENDER_MODE;
+RenderMode frameMode = RENDER_MODE; // what this frame draws with, renderMode or its fallback while that is unavailable
+const char *renderModeNames[RENDER_MODE_COUNT] = {"Immediate", "Static GPU", "Instanced", "Sorted", "Software"};
 
 string imgFiles[IMG_ARRAY_SIZE] = {
     "assets/tile_1.png",
@@ -32,30 +58,154 @@ string imgFiles[IMG_ARRAY_SIZE] = {
     "assets/tile_5.png",
 };
 size_t imgFilesSize = IMG_ARRAY_SIZE;
-Image tileImg;
-Texture tileTexArray[IMG_ARRAY_SIZE];
-Texture tileTex;
+TileAtlas tileAtlas; // every tile texture packed into one
 float stddev = DIST_STDDEV;
 
-vector<int> tileMap;
+TileMap tileMap;
+unsigned int tileMapVersion = 0; // bumped whenever tileMap changes, GPU buffers rebuild on change
+GpuGrid gpuGrid;
+InstancedGrid instancedGrid;
+AltitudeField altitudeField; // per-frame altitude of every tile, read by drawTiles()
+RenderCache renderCache;     // tile pass of a scene that does not animate
+DrawList drawList;           // sprites of the frame in iso depth order
+bool occlusionCulling = OCCLUSION_CULLING;
+OcclusionBuffer occlusion;   // horizon of the tiles already known to be drawn, see occludeTile()
+vector<DrawEntry> heldTiles; // tiles of the frame in draw order, held back for the occlusion pass
+bool retainStatic = RETAIN_STATIC;
+bool showProfiler = SHOW_PROFILER;
+double simulatedTime = -1.0; // fixed clock for benchmarks, GetTime() when negative
+long long mapSeed = MAP_SEED; // fixed seed for arrangeRandomTiles(), a fresh one per map when negative
+uint64_t tileSeed = 0;        // seed the current tileMap was generated from
+vector<double> tileWeights;   // --weights, chance of each tile; empty for a normal around the middle tile
+AliasTable tileSampler;       // built from tileWeights or the normal, rebuilt when stddev changes
+float samplerStddev = -1.f;   // stddev tileSampler was built for
+ViewCamera viewCamera;        // pans and zooms the tile field
+World world;                  // unbounded map streamed in around the camera, laid out like tileMap
+bool worldMode = WORLD_MODE;  // draw the world instead of tileMap
+Vector2 worldFocus = {0, 0};  // world tile (col, row) under the camera target
+Vector2 worldMotion = {0, 0}; // tiles worldFocus moved by this frame, prefetching looks ahead along it
+int worldColOrigin = 0;       // world tile drawn as local tile (0, 0) this frame, chunk aligned
+int worldRowOrigin = 0;
+int pickedCol = -1;           // tile under the mouse in the grid drawn this frame (a block when zoomed out), -1 for none
+int pickedRow = -1;
+int pickedLod = 1;            // tiles per side of a block of that grid
+int pickedLayer = 0;          // top layer of the picked column, its outline goes there
+bool outlineWithTiles = false; // the picked tile outlines itself while drawn, otherwise drawPickedOutline() goes over the field
+FieldLayout fieldLayout;      // grid drawn this frame, laid out every frame even when it comes from the render cache
+VoxelStacks voxelStacks;      // tiles stacked on the cells of tileMap
+int hillBuilds = 0;           // presses of B since the map was generated, each raises new hills
+int maxTileHeight = 0;        // bound on the base heights of tileMap, 0 until R raises a tile
+EditLog editLog;              // undo / redo history of painting on tileMap
+EditTool editTool = EDIT_TOOL;
+const char *editToolNames[EDIT_TOOL_COUNT] = {"Brush", "Rectangle", "Fill"};
+int brushRadius = BRUSH_RADIUS;
+TileId paintId = 0;               // tile the left mouse button paints, cycled with T
+bool painting = false;            // left button went down on the map, the edit stays open until it is released
+int paintCol = 0, paintRow = 0;   // last brush dab, or the corner a rectangle started from
+SoftwareRenderer softwareRenderer; // CPU rasteriser behind RENDER_SOFTWARE
+bool headless = false;             // no window or GL context, only RENDER_SOFTWARE can draw
 
 // Function Declarations
 void handleEvents();
+void handlePainting();
+void mapEdited();
 void drawGame();
-void drawTile(Texture &tile, int x, int y, Vector2 startPos, int size, float altitude, bool showOutline = false);
+void layoutTileField(Vector2 startPos); // places the grid drawn this frame in fieldLayout
+void pickFieldTile();                   // the tile of that grid under the mouse
+void drawTileField();
+void drawPickedOutline();               // over the finished field
+void drawTiles(const VisibleTiles &visible, Vector2 startPos, int lod);
+void drawTileBlocks(const VisibleTiles &visible, Vector2 startPos, int lod);
+void drawTileChunks(const VisibleTiles &visible, Vector2 startPos);
+void submitTile(int colIndex, int rowIndex, int tile, float altitude, Vector2 startPos, int size, int lod, int layer = 0); // hands one tile to the current render mode
+void emitTile(int colIndex, int rowIndex, int tile, float altitude, Vector2 startPos, int size, int lod, bool outline);     // draws or queues it there
+void drawUnoccludedTiles(Vector2 startPos, int size, int lod); // the held tiles that tiles in front of them do not cover
+void beginTileOcclusion(const vector<DrawEntry> &entries, int lod);
+bool tileOccluded(const DrawEntry &entry, Vector2 startPos, int size, int lod); // tested front to back, see occludeTile()
+void submitColumn(int colIndex, int rowIndex, int tile, float altitude, const VoxelColumn &column, Vector2 startPos, int size, int lod);   // the layers of a stack that may show
+const TileId *chunkIds(int chunkCol, int chunkRow);
+TileId tileIdAt(int col, int row);
+int placeWorldWindow(Rectangle view, Vector2 &startPos);
+float voxelLayerHeight(int lod); // pixels between stacked tiles of the grid drawn at lod
+int cellLayers(int col, int row); // layers of the stack on a map tile, 1 for a lone tile or in the world
+void drawSorted(DrawList &list, Vector2 startPos, int size, int lod);
+void chooseFrameMode(); // sets frameMode for the frame about to be drawn
+bool renderModeAvailable(RenderMode mode);
+void drawTile(TileAtlas &atlas, int tileIndex, int x, int y, Vector2 startPos, int size, float altitude, bool showOutline = false, int lod = 1);
+void drawTileOutline(const TileAtlas &atlas, int x, int y, Vector2 startPos, int size, float altitude, int lod);
 void drawText(bool showText);
+void drawLabel(const char *text, int x, int y, int fontSize, Color color);
 unsigned int prepareAssets(string files[], size_t limit);
-Vector2 transform(Vector2 v);
 void arrangeRandomTiles();
+void resizeGrid();
+void updateMemoryStats();
+double frameTime();
+int runBenchmark(int frames, const char *outPath);
+Image captureFrame();
+int runGolden(bool record, const char *dir);
 
 // Entry Point
-int main()
+int main(int argc, char *argv[])
 {
+    int benchFrames = 0; // --bench [frames]: measure the pipeline headless and exit
+    const char *benchOutput = BENCH_OUTPUT;
+    int goldenMode = 0; // --golden record|check [dir]: 1 records reference frames, 2 compares against them
+    const char *goldenDir = GOLDEN_DIR;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+        {
+            benchFrames = BENCH_FRAMES;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                benchFrames = max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc)
+            benchOutput = argv[++i];
+        else if (strcmp(argv[i], "--software") == 0)
+            renderMode = RENDER_SOFTWARE;
+        else if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            mapSeed = strtoll(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc)
+        {
+            // comma separated, one per tile in imgFiles order, missing ones are 0
+            tileWeights.assign(imgFilesSize, 0.0);
+            char *next = argv[++i];
+            for (size_t tile = 0; tile < imgFilesSize && *next; tile++)
+            {
+                tileWeights[tile] = strtod(next, &next);
+                if (*next == ',')
+                    next++;
+            }
+            AliasTable check;
+            if (!buildAliasTable(check, tileWeights))
+            {
+                cout << "Ignoring --weights, no tile has a positive weight\n";
+                tileWeights.clear();
+            }
+        }
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+        {
+            goldenMode = strcmp(argv[++i], "record") == 0 ? 1 : 2;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                goldenDir = argv[++i];
+        }
+    }
+    if (headless && !benchFrames && !goldenMode)
+        benchFrames = BENCH_FRAMES; // nothing to show without a window, measure instead
 
-    SetTargetFPS(FPS);
+    bool offscreen = benchFrames || goldenMode;
+    SetTargetFPS(offscreen ? 0 : FPS); // benchmarks run uncapped
     SetTraceLogLevel(LOG_ERROR);
+    if (offscreen)
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
 
-    if (FULLSCREEN) // use full screen
+    if (headless)
+    {
+        renderMode = RENDER_SOFTWARE; // everything else needs a GL context
+    }
+    else if (FULLSCREEN && !offscreen) // use full screen
     {
         int monitor = GetCurrentMonitor();
         InitWindow(GetMonitorWidth(monitor), GetMonitorHeight(monitor), SCREEN_TITLE);
@@ -77,18 +227,48 @@ int main()
         return -1;
     }
 
-    tileMap.resize(static_cast<long unsigned int>(gridSize * gridSize), 3); // initialize vector with a default value
+    initSoftwareRenderer(softwareRenderer, tileAtlas);
+    softwareRenderer.incremental = SOFTWARE_INCREMENTAL;
+    resetViewCamera(viewCamera, {(float)w / 2.f, (float)h / 2.f}, {(float)w / 2.f, (float)h / 2.f}); // no pan or zoom to start with
+    viewCamera.smooth = CAMERA_SMOOTH;
+    initWorld(world, WORLD_MEMORY_BUDGET);
+    initEditLog(editLog, EDIT_LOG_BUDGET);
+    if (!headless)
+    {
+        loadGpuGrid(gpuGrid);
+        loadInstancedGrid(instancedGrid);
+    }
+    if (!renderModeAvailable(renderMode))
+        renderMode = RENDER_IMMEDIATE; // shader unavailable, fall back to plain batching
 
     arrangeRandomTiles(); // allocate a normal distribution biased random index to each tile position
-    while (!WindowShouldClose())
+
+    int exitCode = 0;
+    if (goldenMode)
+        exitCode = runGolden(goldenMode == 1, goldenDir);
+    else if (benchFrames)
+        exitCode = runBenchmark(benchFrames, benchOutput);
+
+    while (!offscreen && !WindowShouldClose())
     {
+        beginPhase(PHASE_EVENTS);
         if (IsWindowFocused())
             handleEvents();
+        updateViewCamera(viewCamera, GetFrameTime());
+        endPhase(PHASE_EVENTS);
 
         drawGame();
     };
 
-    return 0;
+    unloadRenderCache(renderCache);
+    unloadInstancedGrid(instancedGrid);
+    unloadGpuGrid(gpuGrid);
+    unloadSoftwareRenderer(softwareRenderer);
+    unloadWorld(world);
+    unloadTileAtlas(tileAtlas);
+    if (!headless)
+        CloseWindow();
+    return exitCode;
 }
 
 void handleEvents()
@@ -106,17 +286,20 @@ void handleEvents()
     if (IsKeyPressed(KEY_K))
         oscilSpeed -= .5f;
 
-    // Grid Size
+    // Grid Size (hold SHIFT to double / halve)
+    bool shiftDown = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
     if (IsKeyPressed(KEY_O))
     {
-        gridSize += 1;
-        arrangeRandomTiles();
+        gridSize = shiftDown ? gridSize * 2 : gridSize + 1;
+        gridSize = min(gridSize, MAX_GRID_SIZE);
+        resizeGrid();
     }
 
     if (IsKeyPressed(KEY_L))
     {
-        gridSize -= 1;
-        arrangeRandomTiles();
+        gridSize = shiftDown ? gridSize / 2 : gridSize - 1;
+        gridSize = max(gridSize, 1);
+        resizeGrid();
     }
 
     // Grid Size
@@ -141,6 +324,89 @@ void handleEvents()
     if (IsKeyPressed(KEY_THREE))
         oscilOption = 3;
 
+    // Frame timing overlay
+    if (IsKeyPressed(KEY_P))
+        showProfiler = !showProfiler;
+
+    // Retained rendering of static scenes
+    if (IsKeyPressed(KEY_C))
+        retainStatic = !retainStatic;
+
+    // Skipping tiles hidden behind nearer ones
+    if (IsKeyPressed(KEY_X))
+        occlusionCulling = !occlusionCulling;
+
+    // Software frame redrawn only where tiles changed
+    if (IsKeyPressed(KEY_D))
+        softwareRenderer.incremental = !softwareRenderer.incremental;
+
+    // Render Mode
+    if (IsKeyPressed(KEY_M))
+    {
+        do
+            renderMode = RenderMode((renderMode + 1) % RENDER_MODE_COUNT);
+        while (!renderModeAvailable(renderMode));
+    }
+
+    // Streaming world, continues the map where it ends
+    if (IsKeyPressed(KEY_W))
+        worldMode = !worldMode;
+
+    // Camera: arrows or right mouse drag pan, the mouse wheel zooms around the cursor
+    Vector2 pan = {(float)IsKeyDown(KEY_RIGHT) - (float)IsKeyDown(KEY_LEFT), (float)IsKeyDown(KEY_DOWN) - (float)IsKeyDown(KEY_UP)};
+    panViewCamera(viewCamera, Vector2Scale(pan, CAMERA_PAN_SPEED * GetFrameTime() * (shiftDown ? 4.f : 1.f)));
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
+        panViewCamera(viewCamera, Vector2Negate(GetMouseDelta()));
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.f)
+        zoomViewCamera(viewCamera, powf(CAMERA_ZOOM_STEP, wheel), GetMousePosition());
+    if (IsKeyPressed(KEY_F))
+        viewCamera.smooth = !viewCamera.smooth;
+
+    // Painting: E cycles the tool, T the tile, [ and ] size the brush, CTRL+Z undoes and CTRL+SHIFT+Z redoes
+    if (IsKeyPressed(KEY_E) && !painting)
+        editTool = EditTool((editTool + 1) % EDIT_TOOL_COUNT);
+    if (IsKeyPressed(KEY_T))
+        paintId = (TileId)((paintId + 1) % imgFilesSize);
+    if (IsKeyPressed(KEY_LEFT_BRACKET))
+        brushRadius = max(brushRadius - 1, 0);
+    if (IsKeyPressed(KEY_RIGHT_BRACKET))
+        brushRadius = min(brushRadius + 1, MAX_BRUSH_RADIUS);
+    bool ctrlDown = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    if (ctrlDown && IsKeyPressed(KEY_Z) && (shiftDown ? redoEdit(editLog, tileMap) : undoEdit(editLog, tileMap)))
+        mapEdited();
+    handlePainting();
+
+    // Stacks: B raises hills (SHIFT+B flattens the map), V stacks the paint tile on the picked column (SHIFT+V takes the top one off)
+    if (IsKeyPressed(KEY_B) && !worldMode)
+    {
+        if (shiftDown)
+            clearVoxelStacks(voxelStacks, gridSize);
+        else
+            raiseVoxelHills(voxelStacks, tileMap, tileSeed + (uint64_t)hillBuilds++, VOXEL_HILLS);
+        markStackedTiles(voxelStacks, tileMap);
+        mapEdited();
+    }
+    if (IsKeyPressed(KEY_V) && !worldMode && pickedCol >= 0)
+    {
+        int col = pickedCol * pickedLod, row = pickedRow * pickedLod;
+        int height = voxelHeight(voxelStacks, col, row);
+        setVoxel(voxelStacks, col, row, shiftDown ? height - 1 : height, paintId, !shiftDown);
+        markStackedTiles(voxelStacks, tileMap);
+        mapEdited();
+    }
+
+    // Heights: R raises the picked tile by a layer (SHIFT+R lowers it), the tile and its stack float up with it
+    if (IsKeyPressed(KEY_R) && !worldMode && pickedCol >= 0)
+    {
+        enableTileHeights(tileMap);
+        int step = (int)voxelLayerHeight(1);
+        uint16_t &height = tileHeights(tileMap)(pickedCol * pickedLod, pickedRow * pickedLod);
+        height = (uint16_t)Clamp((float)(height + (shiftDown ? -step : step)), 0.f, (float)(step * (VOXEL_MAX_LAYERS - 1)));
+        maxTileHeight = max(maxTileHeight, (int)height); // only grows, a bound is enough
+        mapEdited();
+    }
+
     // Revert to original values
     if (IsKeyPressed(KEY_SPACE))
     {
@@ -148,6 +414,7 @@ void handleEvents()
         amplitude = AMPLITUDE;
         oscilSpeed = OSCIl_SPEED;
         stddev = DIST_STDDEV;
+        resetViewCamera(viewCamera, {(float)w / 2.f, (float)h / 2.f}, {(float)w / 2.f, (float)h / 2.f});
         arrangeRandomTiles();
     }
 
@@ -160,67 +427,575 @@ void handleEvents()
     // cout << "Amplitude: " << amplitude << "\n";
 };
 
+void handlePainting()
+{
+    // picking happens while drawing, so this is the tile that was under the mouse last frame
+    int col = pickedCol * pickedLod;
+    int row = pickedRow * pickedLod;
+    bool overMap = !worldMode && pickedCol >= 0; // the world is generated, not painted
+    int changed = 0;
+
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && overMap)
+    {
+        if (painting) // the release ending the last stroke never arrived, the window lost focus mid-stroke
+            endEdit(editLog, tileMap);
+        beginEdit(editLog);
+        painting = true;
+        paintCol = col;
+        paintRow = row;
+        if (editTool == EDIT_BRUSH)
+            changed += paintBrush(editLog, tileMap, col, row, brushRadius, paintId);
+        else if (editTool == EDIT_FILL)
+            changed += floodFill(editLog, tileMap, col, row, paintId);
+    }
+    else if (painting && editTool == EDIT_BRUSH && overMap && (col != paintCol || row != paintRow))
+    {
+        changed += paintStroke(editLog, tileMap, paintCol, paintRow, col, row, brushRadius, paintId);
+        paintCol = col;
+        paintRow = row;
+    }
+
+    // the whole stroke, rectangle or fill becomes one command; a fill is complete on the click
+    if (painting && (editTool == EDIT_FILL || IsMouseButtonReleased(MOUSE_BUTTON_LEFT)))
+    {
+        if (editTool == EDIT_RECT && overMap)
+            changed += paintRect(editLog, tileMap, paintCol, paintRow, col, row, paintId);
+        endEdit(editLog, tileMap);
+        painting = false;
+    }
+    if (changed > 0)
+        mapEdited();
+}
+
+void mapEdited()
+{
+    tileMapVersion++; // GPU buffers and the render cache follow the map
+    updateMemoryStats();
+}
+
 void drawGame()
 {
-    BeginDrawing();
-    ClearBackground(bgColor);
+    if (!headless)
+    {
+        BeginDrawing();
+        ClearBackground(bgColor);
+    }
+    resetDrawStats();
 
-    Vector2 startPos = {((float)w - (float)tileTex.width) / 2.f, // to center a unit tile to its center
+    Vector2 startPos = {((float)w - (float)tileAtlas.tileWidth) / 2.f, // to center a unit tile to its center
                         (float)h / 2.f};
 
-    for (int rowIndex = 0; rowIndex < gridSize; rowIndex++)
+    chooseFrameMode();
+
+    // without oscillation every frame is the same image, draw it once and blit it afterwards
+    bool cameraStill = viewCamera.camera.target.x == viewCamera.goal.x && viewCamera.camera.target.y == viewCamera.goal.y;
+    bool staticScene = !headless && !worldMode && cameraStill && retainStatic && (oscilSpeed == 0.f || amplitude == 0.f);
+    RenderCacheKey cacheKey = {gridSize, stddev, tileMapVersion, GetScreenWidth(), GetScreenHeight(),
+                               amplitude, oscilSpeed, oscilOption, frameMode,
+                               viewCamera.camera.target, viewCamera.camera.zoom};
+    beginPhase(PHASE_TILES);
+    layoutTileField(startPos);
+    pickFieldTile(); // every frame, a cached field still follows the mouse
+    // modes drawing tile by tile outline the picked one in place, only where it is not cached
+    outlineWithTiles = !staticScene && (frameMode == RENDER_IMMEDIATE || frameMode == RENDER_SORTED);
+    if (staticScene && renderCacheValid(renderCache, cacheKey))
+        drawRenderCache(renderCache);
+    else if (staticScene)
+    {
+        beginRenderCache(renderCache, cacheKey, bgColor);
+        drawTileField();
+        endRenderCache(renderCache);
+        drawRenderCache(renderCache);
+    }
+    else
+        drawTileField();
+    if (pickedCol >= 0 && !outlineWithTiles)
+        drawPickedOutline();
+    endPhase(PHASE_TILES);
+
+    if (!headless)
+    {
+        beginPhase(PHASE_TEXT);
+        drawText(SHOW_TEXT);
+        endPhase(PHASE_TEXT);
+
+        if (showProfiler)
+            drawProfilerOverlay(w - 330, 5, fgColor);
+
+        beginPhase(PHASE_PRESENT);
+        EndDrawing();
+        endPhase(PHASE_PRESENT);
+    }
+    endProfilerFrame();
+};
+
+void layoutTileField(Vector2 startPos)
+{
+    // startPos lays the field out as if the camera did not move, culling works on the part the camera shows
+    Rectangle view = viewCameraRect(viewCamera, w, h);
+    int lod = tileLod(viewCamera.camera.zoom, tileAtlas.tileWidth);
+    int size = gridSize;
+    if (worldMode)
+    {
+        beginWorldFrame(world);
+        Vector2 focus = tileCell(viewCamera.camera.target, startPos, gridSize, tileAtlas.tileWidth, tileAtlas.tileHeight);
+        worldMotion = Vector2Subtract(focus, worldFocus);
+        worldFocus = focus;
+        size = placeWorldWindow(view, startPos);
+    }
+
+    beginPhase(PHASE_ALTITUDE);
+    // the static buffer evaluates altitude in its vertex shader, picking still needs the field
+    setAltitudeBase(altitudeField, worldMode ? TileSpan<const uint16_t>{nullptr, 0} : tileHeights(as_const(tileMap)), (float)maxTileHeight);
+    updateAltitudeField(altitudeField, size, (float)frameTime(), oscilSpeed, amplitude, oscilOption,
+                        worldMode ? worldColOrigin : 0, worldMode ? worldRowOrigin : 0);
+    endPhase(PHASE_ALTITUDE);
+
+    // zoomed out, each lod x lod block of tiles is drawn as one tile lod times the size: a grid of
+    // ceil(size / lod) tiles of lod * tileWidth, placed so its tiles cover the blocks they stand for
+    int blocks = (size + lod - 1) / lod;
+    if (lod > 1)
+        startPos.y += (float)(tileAtlas.tileHeight * lod * blocks / 4) - (float)(tileAtlas.tileHeight * size / 4);
+    float stackHeight = worldMode ? 0.f : (float)(voxelStacks.maxLayers - 1) * voxelLayerHeight(lod); // stacks rise above the altitude
+    fieldLayout = {startPos, size, lod, blocks, stackHeight,
+                   visibleTiles(startPos, blocks, tileAtlas.tileWidth * lod, tileAtlas.tileHeight * lod, view, amplitude + altitudeField.maxBase + stackHeight)};
+}
+
+void pickFieldTile()
+{
+    // picked in the grid being drawn, so zoomed out the whole block under the mouse lights up; a stack is picked by its top
+    const FieldLayout &field = fieldLayout;
+    int lod = field.lod;
+    pickedCol = pickedRow = -1;
+    pickedLod = lod;
+    pickedLayer = 0;
+    if (headless)
+        return;
+    pickTile(GetScreenToWorld2D(GetMousePosition(), viewCamera.camera), field.startPos, field.blocks, tileAtlas.tileWidth * lod, tileAtlas.tileHeight * lod,
+             altitudeField.minAltitude, altitudeField.maxAltitude + field.stackHeight,
+             [lod](int col, int row)
+             { return altitudeAt(altitudeField, row * lod, col * lod) + (float)(cellLayers(col * lod, row * lod) - 1) * voxelLayerHeight(lod); },
+             [lod](int col, int row)
+             { return (float)(cellLayers(col * lod, row * lod) - 1) * voxelLayerHeight(lod); },
+             pickedCol, pickedRow);
+    if (pickedCol >= 0)
+        pickedLayer = cellLayers(pickedCol * lod, pickedRow * lod) - 1;
+}
+
+void drawTileField()
+{
+    const FieldLayout &field = fieldLayout;
+    Vector2 startPos = field.startPos;
+    const VisibleTiles &visible = field.visible;
+    int lod = field.lod;
+    int blocks = field.blocks;
+
+    bool cameraMode = frameMode != RENDER_SOFTWARE; // the software renderer applies the camera per tile
+    if (cameraMode)
+    {
+        BeginMode2D(viewCamera.camera);
+        countFlush();
+    }
+    switch (frameMode)
+    {
+    case RENDER_STATIC_GPU:
+        // geometry only changes with the map, everything else is a handful of uniforms
+        updateGpuGrid(gpuGrid, tileMap, tileMapVersion);
+        drawGpuGrid(gpuGrid, tileAtlas, visible, startPos, (float)frameTime(), oscilSpeed, amplitude, oscilOption, fgColor);
+        break;
+    case RENDER_INSTANCED:
+        drawTiles(visible, startPos, lod); // only collects instances
+        drawInstancedGrid(instancedGrid, tileAtlas, startPos, blocks, lod, fgColor);
+        break;
+    case RENDER_SORTED:
+        drawTiles(visible, startPos, lod); // only fills the draw list
+        drawSorted(drawList, startPos, blocks, lod);
+        break;
+    case RENDER_SOFTWARE:
+        beginSoftwareFrame(softwareRenderer, w, h, bgColor, fgColor);
+        drawTiles(visible, startPos, lod); // only collects tile positions
+        renderSoftwareFrame(softwareRenderer, workerPool());
+        if (!headless)
+            presentSoftwareFrame(softwareRenderer);
+        break;
+    case RENDER_IMMEDIATE:
+    default:
+        drawTiles(visible, startPos, lod);
+    }
+    if (cameraMode)
+    {
+        EndMode2D();
+        countFlush();
+    }
+
+    if (worldMode)
     {
-        for (int colIndex = 0; colIndex < gridSize; colIndex++)
+        endWorldFrame(world, worldMotion.x, worldMotion.y);
+        memoryStats.worldChunks = (int)world.lru.size();
+        memoryStats.worldBytes = worldBytes(world);
+        memoryStats.worldPending = world.pending;
+    }
+};
+
+void drawPickedOutline()
+{
+    const FieldLayout &field = fieldLayout;
+    BeginMode2D(viewCamera.camera);
+    float altitude = altitudeAt(altitudeField, pickedRow * field.lod, pickedCol * field.lod) + (float)pickedLayer * voxelLayerHeight(field.lod);
+    drawTileOutline(tileAtlas, pickedCol, pickedRow, field.startPos, field.blocks, altitude, field.lod);
+    EndMode2D();
+    countFlush();
+}
+
+void drawTiles(const VisibleTiles &visible, Vector2 startPos, int lod)
+{
+    // with occlusion culling the tiles are held until the whole field is known, the sorted draw list
+    // is culled once it is in order (see drawSorted())
+    heldTiles.clear();
+    if (lod > 1)
+        drawTileBlocks(visible, startPos, lod);
+    else
+        drawTileChunks(visible, startPos);
+    if (occlusionCulling && frameMode != RENDER_SORTED)
+        drawUnoccludedTiles(startPos, visible.size, lod);
+}
+
+void drawTileChunks(const VisibleTiles &visible, Vector2 startPos)
+{
+    // visible chunks back to front (see ChunkBand), so every chunk of the map is read in one go
+    static vector<float> bandAltitudes; // altitudes of the visible tiles of one band, row after row
+    size_t rowOffsets[TILE_CHUNK_SIZE];
+    ChunkBand band;
+    const int mask = TILE_CHUNK_SIZE - 1;
+
+    int chunkRowBegin;
+    int chunkRows = visibleChunkRows(visible, chunkRowBegin);
+    for (int chunkRow = chunkRowBegin; chunkRow < chunkRowBegin + chunkRows; chunkRow++)
+    {
+        if (!visibleChunkBand(visible, chunkRow, band))
+            continue;
+
+        beginPhase(PHASE_ALTITUDE);
+        size_t count = 0;
+        for (int i = 0; i < band.rowEnd - band.rowBegin; i++)
         {
-            int i = (rowIndex * gridSize) + colIndex;
-            tileTex = tileTexArray[tileMap[static_cast<unsigned long int>(i)]];
+            rowOffsets[i] = count;
+            count += static_cast<size_t>(max(band.colEnd[i] - band.colBegin[i], 0));
+        }
+        bandAltitudes.resize(count);
+        for (int i = 0; i < band.rowEnd - band.rowBegin; i++)
+            if (band.colBegin[i] < band.colEnd[i])
+                altitudeRow(altitudeField, band.rowBegin + i, band.colBegin[i], band.colEnd[i] - band.colBegin[i], bandAltitudes.data() + rowOffsets[i]);
+        endPhase(PHASE_ALTITUDE);
 
-            auto getAlt = [&](float speed, float maxAlt, unsigned short option)
+        for (int chunkCol = band.chunkColBegin; chunkCol < band.chunkColEnd; chunkCol++)
+        {
+            const TileId *chunk = chunkIds(chunkCol, chunkRow);
+            const VoxelChunk *voxels = worldMode ? nullptr : voxelChunk(voxelStacks, chunkCol, chunkRow); // null for chunks without stacks
+            for (int rowIndex = band.rowBegin; rowIndex < band.rowEnd; rowIndex++)
             {
-                switch (option)
+                int i = rowIndex - band.rowBegin;
+                int colBegin = max(band.colBegin[i], chunkCol << TILE_CHUNK_SHIFT);
+                int colEnd = min(band.colEnd[i], (chunkCol + 1) << TILE_CHUNK_SHIFT);
+                const TileId *chunkRowIds = chunk + ((rowIndex & mask) << TILE_CHUNK_SHIFT);
+                const float *altitudes = bandAltitudes.data() + rowOffsets[i]; // starts at band.colBegin[i]
+
+                if (!voxels)
+                {
+                    for (int colIndex = colBegin; colIndex < colEnd; colIndex++)
+                        submitTile(colIndex, rowIndex, chunkRowIds[colIndex & mask], altitudes[colIndex - band.colBegin[i]], startPos, visible.size, 1);
+                    continue;
+                }
+                for (int colIndex = colBegin; colIndex < colEnd; colIndex++)
                 {
-                case 1:
-                    return sinf((float)rowIndex + (float)GetTime() * speed) * maxAlt; // along row
-                    break;
-                case 2:
-                    return sinf((float)colIndex + (float)GetTime() * speed) * maxAlt; // along col
-                    break;
-                case 3:
-                default:
-                    return sinf((float)rowIndex + (float)GetTime() * speed) * sinf((float)colIndex + (float)GetTime() * speed) * maxAlt; // along both
+                    const VoxelColumn *column = chunkColumn(*voxels, colIndex, rowIndex);
+                    if (column)
+                        submitColumn(colIndex, rowIndex, chunkRowIds[colIndex & mask], altitudes[colIndex - band.colBegin[i]], *column, startPos, visible.size, 1);
+                    else
+                        submitTile(colIndex, rowIndex, chunkRowIds[colIndex & mask], altitudes[colIndex - band.colBegin[i]], startPos, visible.size, 1);
                 }
-            };
-
-            drawTile(tileTex,
-                     colIndex,
-                     rowIndex,
-                     startPos,
-                     gridSize,
-                     getAlt(oscilSpeed, amplitude, oscilOption),
-                     false);
-
-            // cout << "Grid: " << gridSize << "x" << gridSize << "  ";
-            // cout << "Oscillation Speed: " << oscilSpeed << "  ";
-            // cout << "Amplitude: " << amplitude << "\n";
+            }
         }
     }
-    drawText(SHOW_TEXT);
+}
 
-    EndDrawing();
-};
+void drawTileBlocks(const VisibleTiles &visible, Vector2 startPos, int lod)
+{
+    // block (col, row) stands for tiles [col * lod, col * lod + lod) x [row * lod, row * lod + lod) and shows the first of them;
+    // blocks are few and far apart in the map, so plain row-major order is fine here
+    int colBegin, colEnd;
+    for (int row = visible.rowBegin; row < visible.rowEnd; row++)
+    {
+        if (!visibleCols(visible, row, colBegin, colEnd))
+            continue;
+        for (int col = colBegin; col < colEnd; col++)
+        {
+            bool stacked = !worldMode && tileHasFlag(tileMap, col * lod, row * lod, TILE_FLAG_STACKED);
+            const VoxelColumn *column = stacked ? voxelColumn(voxelStacks, col * lod, row * lod) : nullptr;
+            if (column)
+                submitColumn(col, row, tileIdAt(col * lod, row * lod), altitudeAt(altitudeField, row * lod, col * lod), *column, startPos, visible.size, lod);
+            else
+                submitTile(col, row, tileIdAt(col * lod, row * lod), altitudeAt(altitudeField, row * lod, col * lod), startPos, visible.size, lod);
+        }
+    }
+}
+
+const TileId *chunkIds(int chunkCol, int chunkRow)
+{
+    if (!worldMode)
+        return tileIds(tileMap).chunk(chunkCol, chunkRow);
+
+    static TileId placeholder[TILE_CHUNK_SIZE * TILE_CHUNK_SIZE];
+    if (placeholder[0] != WORLD_PLACEHOLDER_TILE)
+        fill_n(placeholder, TILE_CHUNK_SIZE * TILE_CHUNK_SIZE, (TileId)WORLD_PLACEHOLDER_TILE);
+
+    // never waits, a chunk still being generated shows as placeholder tiles
+    const TileId *chunk = worldChunk(world, (worldColOrigin >> TILE_CHUNK_SHIFT) + chunkCol, (worldRowOrigin >> TILE_CHUNK_SHIFT) + chunkRow);
+    return chunk ? chunk : placeholder;
+}
+
+TileId tileIdAt(int col, int row)
+{
+    const int mask = TILE_CHUNK_SIZE - 1;
+    return chunkIds(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT)[((row & mask) << TILE_CHUNK_SHIFT) | (col & mask)];
+}
+
+int placeWorldWindow(Rectangle view, Vector2 &startPos)
+{
+    // the world is laid out like a gridSize map; draw the chunk aligned square of it that covers the view
+    // (grown by a tile and the amplitude, as visibleTiles() does) as a map of its own
+    float tileW = (float)tileAtlas.tileWidth;
+    float tileH = (float)tileAtlas.tileHeight;
+    float left = view.x - tileW, right = view.x + view.width + tileW;
+    float top = view.y - tileH - amplitude, bottom = view.y + view.height + tileH + amplitude;
+    Vector2 corners[4] = {tileCell({left, top}, startPos, gridSize, tileAtlas.tileWidth, tileAtlas.tileHeight),
+                          tileCell({right, top}, startPos, gridSize, tileAtlas.tileWidth, tileAtlas.tileHeight),
+                          tileCell({left, bottom}, startPos, gridSize, tileAtlas.tileWidth, tileAtlas.tileHeight),
+                          tileCell({right, bottom}, startPos, gridSize, tileAtlas.tileWidth, tileAtlas.tileHeight)};
+
+    Vector2 lo = corners[0], hi = corners[0];
+    for (const Vector2 &corner : corners)
+    {
+        lo = {min(lo.x, corner.x), min(lo.y, corner.y)};
+        hi = {max(hi.x, corner.x), max(hi.y, corner.y)};
+    }
+    worldColOrigin = (int)floorf(lo.x / TILE_CHUNK_SIZE) * TILE_CHUNK_SIZE;
+    worldRowOrigin = (int)floorf(lo.y / TILE_CHUNK_SIZE) * TILE_CHUNK_SIZE;
+    int span = (int)ceilf(max(hi.x - (float)worldColOrigin, hi.y - (float)worldRowOrigin)) + 1;
+    int size = (span + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE * TILE_CHUNK_SIZE;
+
+    // local tile (0, 0) must land where world tile (worldColOrigin, worldRowOrigin) is, see tileScreenPosition()
+    Vector2 iso = transform({(float)worldColOrigin * tileW, (float)worldRowOrigin * tileH});
+    startPos.x += iso.x / 2.f;
+    startPos.y += iso.y / 2.f + (float)(tileAtlas.tileHeight * size / 4) - (float)(tileAtlas.tileHeight * gridSize / 4);
+    return size;
+}
+
+void submitTile(int colIndex, int rowIndex, int tile, float altitude, Vector2 startPos, int size, int lod, int layer)
+{
+    bool outline = outlineWithTiles && colIndex == pickedCol && rowIndex == pickedRow && layer == pickedLayer;
+    if (frameMode == RENDER_SORTED)
+    {
+        pushDraw(drawList, colIndex, rowIndex, layer, DRAW_PASS_TILE, tile, altitude);
+        if (outline)
+            pushDraw(drawList, colIndex, rowIndex, layer, DRAW_PASS_OVERLAY, tile, altitude);
+        return;
+    }
+    if (occlusionCulling)
+    {
+        heldTiles.push_back({0, colIndex, rowIndex, altitude, tile, outline});
+        return;
+    }
+    emitTile(colIndex, rowIndex, tile, altitude, startPos, size, lod, outline);
+}
+
+void emitTile(int colIndex, int rowIndex, int tile, float altitude, Vector2 startPos, int size, int lod, bool outline)
+{
+    if (frameMode == RENDER_INSTANCED)
+    {
+        pushTileInstance(instancedGrid,
+                         colIndex,
+                         rowIndex,
+                         tile,
+                         altitude);
+        return;
+    }
+    if (frameMode == RENDER_SOFTWARE)
+    {
+        Vector2 pos = tileScreenPosition(colIndex, rowIndex, tileAtlas.tileWidth * lod, tileAtlas.tileHeight * lod, startPos, size, altitude);
+        pos = GetWorldToScreen2D(pos, viewCamera.camera);
+        pushSoftwareTile(softwareRenderer, (int)pos.x, (int)pos.y, tile, viewCamera.camera.zoom * (float)lod);
+        return;
+    }
+
+    drawTile(tileAtlas,
+             tile,
+             colIndex,
+             rowIndex,
+             startPos,
+             size,
+             altitude,
+             outline,
+             lod);
+}
+
+void drawUnoccludedTiles(Vector2 startPos, int size, int lod)
+{
+    // front to back, the reverse of the draw order, then the tiles left in draw order
+    beginTileOcclusion(heldTiles, lod);
+    for (size_t i = heldTiles.size(); i-- > 0;)
+        if (tileOccluded(heldTiles[i], startPos, size, lod))
+            heldTiles[i].tile = -1;
+    for (const DrawEntry &entry : heldTiles)
+        if (entry.tile >= 0)
+            emitTile(entry.col, entry.row, entry.tile, entry.altitude, startPos, size, lod, entry.outline);
+    drawStats.occludedTiles += occlusion.culled;
+}
 
-void drawTile(Texture &tile, int x, int y, Vector2 startPos, int size, float altitude, bool showOutline)
+void beginTileOcclusion(const vector<DrawEntry> &entries, int lod)
 {
+    int diagMin = 0, diagMax = 0;
+    if (!entries.empty())
+        diagMin = diagMax = entries[0].col - entries[0].row;
+    for (const DrawEntry &entry : entries)
+    {
+        diagMin = min(diagMin, entry.col - entry.row);
+        diagMax = max(diagMax, entry.col - entry.row);
+    }
 
-    Vector2 isoCoords = transform({float(x * tile.width), float(y * tile.height)}); // isometric transformation
-    isoCoords.x = startPos.x + (isoCoords.x / 2.f) - (float)(tile.width / 2);
-    isoCoords.y = startPos.y + (isoCoords.y / 2.f) - (float)(tile.height * size / 4);
+    /**
+     * Tiles land up to a pixel off where the horizon expects them: drawTile() truncates world positions,
+     * the software renderer truncates screen positions and rounds the scaled size of a tile, which moves
+     * its texels against another tile's by up to a pixel per tile height between them. Profiles are
+     * grown by that many texels, so a tile is only culled when it stays covered either way.
+     */
+    float scale = viewCamera.camera.zoom * (float)lod;
+    float margin = 1.f + 1.f / scale;
+    if (frameMode == RENDER_SOFTWARE)
+    {
+        float drawn = max(1.f, floorf((float)tileAtlas.tileHeight * scale));
+        float reach = (float)(tileAtlas.tileWidth + tileAtlas.tileHeight) + (2.f * amplitude + altitudeField.maxBase + (float)(voxelStacks.maxLayers - 1) * voxelLayerHeight(lod)) / (float)lod;
+        margin += fabsf((float)tileAtlas.tileHeight * scale / drawn - 1.f) * reach;
+    }
+    beginOcclusion(occlusion, diagMin, diagMax, lod, (int)ceilf(margin));
+}
+
+bool tileOccluded(const DrawEntry &entry, Vector2 startPos, int size, int lod)
+{
+    Vector2 pos = tileScreenPosition(entry.col, entry.row, tileAtlas.tileWidth * lod, tileAtlas.tileHeight * lod, startPos, size, entry.altitude);
+    return occludeTile(occlusion, entry.tile, entry.col - entry.row, (int)pos.y);
+}
+
+void submitColumn(int colIndex, int rowIndex, int tile, float altitude, const VoxelColumn &column, Vector2 startPos, int size, int lod)
+{
+    // layers covered by the one above and both front neighbours are skipped; a block's neighbours
+    // are other blocks, not the columns the masks were made for, so blocks draw every layer
+    uint32_t layers = column.solid;
+    if (lod == 1)
+    {
+        float rightAltitude = colIndex + 1 < altitudeField.size ? altitudeAt(altitudeField, rowIndex, colIndex + 1) : altitude;
+        float leftAltitude = rowIndex + 1 < altitudeField.size ? altitudeAt(altitudeField, rowIndex + 1, colIndex) : altitude;
+        layers = visibleVoxelLayers(column, altitude, rightAltitude, leftAltitude, voxelLayerHeight(1));
+    }
+    drawStats.hiddenTiles += __builtin_popcount(column.solid & ~layers);
+
+    for (; layers; layers &= layers - 1) // bottom layer first
+    {
+        int layer = __builtin_ctz(layers);
+        submitTile(colIndex, rowIndex, layer ? column.tiles[layer] : tile, altitude + (float)layer * voxelLayerHeight(lod), startPos, size, lod, layer);
+    }
+}
+
+float voxelLayerHeight(int lod)
+{
+    return (float)(tileAtlas.tileHeight * lod) * VOXEL_LAYER_HEIGHT;
+}
+
+int cellLayers(int col, int row)
+{
+    // the flag answers for lone tiles, which are most of them, without looking up the stacks
+    if (worldMode || !tileHasFlag(tileMap, col, row, TILE_FLAG_STACKED))
+        return 1;
+    return voxelHeight(voxelStacks, col, row);
+}
+
+void drawSorted(DrawList &list, Vector2 startPos, int size, int lod)
+{
+    sortDrawList(list);
+    static vector<bool> occluded; // by position in the sorted order
+    occluded.assign(list.order.size(), false);
+    if (occlusionCulling)
+    {
+        beginTileOcclusion(list.entries, lod);
+        for (size_t i = list.order.size(); i-- > 0;)
+            if (drawPass(drawEntry(list, i)) == DRAW_PASS_TILE) // overlays neither cover nor hide behind tiles
+                occluded[i] = tileOccluded(drawEntry(list, i), startPos, size, lod);
+        drawStats.occludedTiles += occlusion.culled;
+    }
+    for (size_t i = 0; i < list.order.size(); i++)
+    {
+        if (occluded[i])
+            continue;
+        const DrawEntry &entry = drawEntry(list, i);
+        if (drawPass(entry) == DRAW_PASS_OVERLAY)
+            drawTileOutline(tileAtlas, entry.col, entry.row, startPos, size, entry.altitude, lod);
+        else
+            drawTile(tileAtlas, entry.tile, entry.col, entry.row, startPos, size, entry.altitude, false, lod);
+    }
+    clearDrawList(list);
+}
+
+void chooseFrameMode()
+{
+    // the static buffer only covers small grids at lod 1, the chosen mode comes back once the view allows it again
+    frameMode = renderMode;
+    if (!renderModeAvailable(frameMode))
+        frameMode = headless ? RENDER_SOFTWARE : instancedGrid.ready ? RENDER_INSTANCED : RENDER_IMMEDIATE;
+}
+
+bool renderModeAvailable(RenderMode mode)
+{
+    switch (mode)
+    {
+    case RENDER_STATIC_GPU:
+        return gpuGrid.ready && gridSize <= GPU_GRID_MAX_SIZE && !worldMode && // built from tileMap
+               tileLod(viewCamera.camera.zoom, tileAtlas.tileWidth) == 1 &&   // tile by tile, no blocks
+               voxelStacks.columns == 0 && maxTileHeight == 0;                 // one flat tile per cell
+    case RENDER_INSTANCED:
+        return instancedGrid.ready;
+    case RENDER_SOFTWARE:
+        return true;
+    default:
+        return !headless;
+    }
+}
+
+void drawTile(TileAtlas &atlas, int tileIndex, int x, int y, Vector2 startPos, int size, float altitude, bool showOutline, int lod)
+{
+    int tileW = atlas.tileWidth * lod;
+    int tileH = atlas.tileHeight * lod;
 
-    isoCoords.y -= altitude; // Makes the tile appear elevated
+    Vector2 isoCoords = tileScreenPosition(x, y, tileW, tileH, startPos, size, altitude);
     if (showOutline)
-        DrawRectangleLines((int)isoCoords.x, (int)isoCoords.y, tile.width, tile.height, RED); // Show outline of tiles
+        drawTileOutline(atlas, x, y, startPos, size, altitude, lod);
 
-    DrawTexture(tile, (int)isoCoords.x, (int)isoCoords.y, fgColor);
+    // same source texture for every tile, so rlgl keeps appending to one batch
+    Rectangle rect = atlas.rects[tileIndex];
+    if (lod == 1)
+        DrawTextureRec(atlas.texture, rect, {(float)(int)isoCoords.x, (float)(int)isoCoords.y}, fgColor);
+    else
+        DrawTexturePro(atlas.texture, rect, {(float)(int)isoCoords.x, (float)(int)isoCoords.y, rect.width * (float)lod, rect.height * (float)lod}, {0, 0}, 0.f, fgColor);
+    countDraw(atlas.texture.id, 4);
+}
+
+void drawTileOutline(const TileAtlas &atlas, int x, int y, Vector2 startPos, int size, float altitude, int lod)
+{
+    int tileW = atlas.tileWidth * lod;
+    int tileH = atlas.tileHeight * lod;
+
+    Vector2 isoCoords = tileScreenPosition(x, y, tileW, tileH, startPos, size, altitude);
+    DrawRectangleLines((int)isoCoords.x, (int)isoCoords.y, tileW, tileH, RED); // Show outline of tiles
+    countDraw(rlGetTextureIdDefault(), 8);
 }
 
 void drawText(bool showText)
@@ -231,83 +1006,276 @@ void drawText(bool showText)
 
         int vertInterval = 20;
         int startDistVert = 5;
-        DrawText(TextFormat("Grid: %dx%d", gridSize, gridSize), 5, startDistVert + (vertInterval * 0), 20, fgColor);
-        DrawText(TextFormat("Oscillation Speed: %.1f", oscilSpeed), 5, startDistVert + (vertInterval * 1), 20, fgColor);
-        DrawText(TextFormat("Amplitude: %.1f", amplitude), 5, startDistVert + (vertInterval * 2), 20, fgColor);
-        DrawText(TextFormat("Standard Deviation: %.1f", stddev), 5, startDistVert + (vertInterval * 3), 20, fgColor);
+        drawLabel(worldMode ? TextFormat("World: %.0f, %.0f", worldFocus.x, worldFocus.y) : TextFormat("Grid: %dx%d", gridSize, gridSize), 5, startDistVert + (vertInterval * 0), 20, fgColor);
+        drawLabel(TextFormat("Oscillation Speed: %.1f", oscilSpeed), 5, startDistVert + (vertInterval * 1), 20, fgColor);
+        drawLabel(TextFormat("Amplitude: %.1f", amplitude), 5, startDistVert + (vertInterval * 2), 20, fgColor);
+        drawLabel(tileWeights.empty() ? TextFormat("Standard Deviation: %.1f", stddev) : "Standard Deviation: custom weights", 5, startDistVert + (vertInterval * 3), 20, fgColor);
+        drawLabel(TextFormat("Draw Calls: %d (%d vertices)", lastDrawStats.drawCalls, lastDrawStats.vertices), 5, startDistVert + (vertInterval * 4), 20, fgColor);
+        drawLabel(TextFormat("Render Mode: %s%s%s", renderModeNames[renderMode], frameMode != renderMode ? TextFormat(" (drawn %s)", renderModeNames[frameMode]) : "", renderCache.valid && retainStatic && (oscilSpeed == 0.f || amplitude == 0.f) ? " (cached)" : ""), 5, startDistVert + (vertInterval * 5), 20, fgColor);
+        drawLabel(TextFormat("Seed: %llu", (unsigned long long)tileSeed), 5, startDistVert + (vertInterval * 6), 20, fgColor);
+        int lod = tileLod(viewCamera.camera.zoom, tileAtlas.tileWidth);
+        drawLabel(lod > 1 ? TextFormat("Zoom: %.2fx (%dx%d blocks)", viewCamera.camera.zoom, lod, lod) : TextFormat("Zoom: %.2fx", viewCamera.camera.zoom), 5, startDistVert + (vertInterval * 7), 20, fgColor);
+        drawLabel(TextFormat("Paint: %s%s, tile %d (undo %d, redo %d, %.1f MiB)", editToolNames[editTool], editTool == EDIT_BRUSH ? TextFormat(" r%d", brushRadius) : "",
+                             paintId + 1, (int)editLog.undo.size(), (int)editLog.redo.size(), (double)editLog.bytes / 1048576.0),
+                  5, startDistVert + (vertInterval * 8), 20, fgColor);
+        if (pickedCol >= 0)
+            drawLabel(TextFormat("Tile: %d, %d", pickedCol * lod + (worldMode ? worldColOrigin : 0), pickedRow * lod + (worldMode ? worldRowOrigin : 0)), 5, startDistVert + (vertInterval * 9), 20, fgColor);
 
         // Bottom Left Text
         vertInterval = 15;
         startDistVert = 15;
 
-        DrawText("( O/L ) for Grid Size", 5, h - (5 * vertInterval + startDistVert), 10, fgColor);
-        DrawText("( I/K ) for Oscillation speed", 5, h - (4 * vertInterval + startDistVert), 10, fgColor);
-        DrawText("( U/J ) for Amplitude", 5, h - (3 * vertInterval + startDistVert), 10, fgColor);
-        DrawText("( Y/H ) for Std Dev", 5, h - (2 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( B ) to Raise Hills, ( SHIFT+B ) to Flatten, ( V / SHIFT+V ) to Stack / Unstack a Tile", 5, h - (12 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( LEFT CLICK ) to Paint, ( E ) Tool, ( T ) Tile, ( [ / ] ) Brush Size, ( CTRL+Z / CTRL+SHIFT+Z ) Undo / Redo", 5, h - (11 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( ARROWS / RIGHT DRAG / WHEEL ) to Pan and Zoom, ( F ) for Smooth Follow", 5, h - (10 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( W ) for Infinite World", 5, h - (9 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( P ) for Frame Timings", 5, h - (8 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( C ) to Cache Static Scenes, ( X ) to Cull Covered Tiles", 5, h - (7 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( M ) for Render Mode, ( D ) to Redraw Changes Only (Software)", 5, h - (6 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( O/L ) for Grid Size", 5, h - (5 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( I/K ) for Oscillation speed", 5, h - (4 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( U/J ) for Amplitude", 5, h - (3 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( Y/H ) for Std Dev", 5, h - (2 * vertInterval + startDistVert), 10, fgColor);
 
-        DrawText("( 1, 2, 3... ) for Options", 5, h - (1 * vertInterval + startDistVert), 10, fgColor);
-        DrawText("( SPACE ) to Reset", 5, h - (0 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( 1, 2, 3... ) for Options", 5, h - (1 * vertInterval + startDistVert), 10, fgColor);
+        drawLabel("( SPACE ) to Reset", 5, h - (0 * vertInterval + startDistVert), 10, fgColor);
     }
 };
 
+void drawLabel(const char *text, int x, int y, int fontSize, Color color)
+{
+    DrawText(text, x, y, fontSize, color);
+    countDraw(GetFontDefault().texture.id, 4 * (int)TextLength(text)); // one quad per glyph, all from the font texture
+}
+
 unsigned int prepareAssets(string files[], size_t limit)
 {
+    if (!buildTileAtlas(tileAtlas, files, limit, !headless)) // Load every tile, resize it and pack them all into one texture
+        return 0;
+    buildOcclusionProfiles(occlusion, tileAtlas);
 
-    for (unsigned long int i = 0; i < limit; i++)
+    for (int i = 0; i < tileAtlas.count; i++)
+        cout << "Packed Tile (" << files[i] << ") at " << tileAtlas.rects[i].x << "," << tileAtlas.rects[i].y
+             << " with width: " << tileAtlas.rects[i].width << " and height: " << tileAtlas.rects[i].height << "\n";
+    return headless ? (unsigned int)tileAtlas.count : tileAtlas.texture.id;
+}
+
+void arrangeRandomTiles()
+{
+    // a fixed seed reproduces the map, otherwise every regeneration gets a new one (shown on screen)
+    tileSeed = mapSeed >= 0 ? static_cast<uint64_t>(mapSeed) : entropySeed();
+    if (tileSampler.alias.empty() || (tileWeights.empty() && samplerStddev != stddev))
     {
-        tileImg = LoadImage(files[i].c_str());                          // upload to RAM
-        ImageResizeNN(&tileImg, tileImg.width * 2, tileImg.height * 2); // 32x32 -> 64x64 (w/ nearest neighbour)
-        tileTexArray[i] = LoadTextureFromImage(tileImg);                // upload to VRAM
-        UnloadImage(tileImg);                                           // unload from RAM
-        cout << "Loaded Texture (" << files[i] << ") with width: " << tileTexArray[i].width << " and height: " << tileTexArray[i].height << "\n";
-        if (!tileTexArray[i].id)
-        {
-            return tileTexArray[i].id;
-        }
+        buildAliasTable(tileSampler, tileWeights.empty() ? normalTileWeights((int)imgFilesSize, stddev) : tileWeights);
+        samplerStddev = stddev;
     }
-    return 1;
+    generateTileMap(tileMap, gridSize, tileSampler, tileSeed, workerPool());
+    resetWorld(world, tileSeed, tileSampler);
+    clearEditLog(editLog); // the history and the stacks belong to the old map
+    painting = false;
+    clearVoxelStacks(voxelStacks, gridSize);
+    hillBuilds = 0;
+    maxTileHeight = 0; // generating zeroed the heights
+    tileMapVersion++;
+    updateMemoryStats();
 }
 
-Vector2 transform(Vector2 v)
+void resizeGrid()
 {
-    /**
-    * Apply matrix transformation
-    * M = [+1.0 -1.0]
-    *     [+0.5 +0.5]
+    // existing tiles stay where they are, only the border that was never generated is drawn
+    resizeTileMap(tileMap, gridSize, tileSampler, workerPool());
+    resizeVoxelStacks(voxelStacks, gridSize);
+    tileMapVersion++;
+    updateMemoryStats();
+}
 
-    * v = <x, y>
+void updateMemoryStats()
+{
+    memoryStats.bytesPerTile = tileMapBytesPerTile(tileMap);
+    memoryStats.paddedBytesPerTile = (float)((double)tileMapBytesAt(tileMap, tileMap.size) / ((double)tileMap.size * (double)tileMap.size));
+    memoryStats.tileMapBytes = tileMapBytes(tileMap);
+    memoryStats.bytesAt4096 = tileMapBytesAt(tileMap, 4096);
+    memoryStats.bytesAt16384 = tileMapBytesAt(tileMap, 16384);
+    memoryStats.voxelColumns = voxelStacks.columns;
+    memoryStats.voxelBytes = voxelStacksBytes(voxelStacks);
+}
+double frameTime()
+{
+    return simulatedTime >= 0.0 ? simulatedTime : GetTime();
+}
 
-    * v' = Mv
+int runBenchmark(int frames, const char *outPath)
+{
+    /**
+     * Sweeps render mode x grid size x oscillation option and runs the full drawGame()
+     * pipeline for `frames` frames per configuration on a fixed simulated clock.
+     * Wall time per frame is measured around drawGame(), phase timings come from the profiler.
      */
+    ofstream out(outPath);
+    if (!out)
+    {
+        cout << "Cannot write benchmark results to " << outPath << "\n";
+        return -1;
+    }
+    out << "render_mode,grid_size,oscil_option,frames,frame_mean_ms,frame_p50_ms,frame_p95_ms,frame_p99_ms,"
+           "altitude_p50_ms,tiles_p50_ms,present_p50_ms,draw_calls,vertices\n";
+
+    const int gridSizes[] = BENCH_GRID_SIZES;
+    vector<double> samples(static_cast<size_t>(frames));
+    for (int mode = 0; mode < RENDER_MODE_COUNT; mode++)
+    {
+        for (int size : gridSizes)
+        {
+            gridSize = min(size, MAX_GRID_SIZE);
+            renderMode = RenderMode(mode);
+            if (!renderModeAvailable(renderMode))
+                continue;
+            arrangeRandomTiles();
+
+            for (unsigned short option = 1; option <= 3; option++)
+            {
+                oscilOption = option;
+                for (int frame = 0; frame < BENCH_WARMUP_FRAMES; frame++)
+                {
+                    simulatedTime = frame * BENCH_TIME_STEP;
+                    drawGame();
+                }
+                resetProfiler();
 
-    return {1.0f * v.x - 1.0f * v.y,
-            0.5f * v.x + 0.5f * v.y};
+                for (int frame = 0; frame < frames; frame++)
+                {
+                    simulatedTime = frame * BENCH_TIME_STEP;
+                    auto start = chrono::steady_clock::now();
+                    drawGame();
+                    samples[static_cast<size_t>(frame)] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                }
+
+                double mean = 0.0;
+                for (double sample : samples)
+                    mean += sample;
+                mean /= frames;
+                vector<double> sorted = samples;
+                sort(sorted.begin(), sorted.end());
+                auto percentile = [&](double p)
+                { return sorted[static_cast<size_t>(p * (frames - 1) + 0.5)]; };
+
+                out << renderModeNames[mode] << "," << gridSize << "," << option << "," << frames << ","
+                    << mean << "," << percentile(0.50) << "," << percentile(0.95) << "," << percentile(0.99) << ","
+                    << phasePercentile(PHASE_ALTITUDE, 0.5) << "," << phasePercentile(PHASE_TILES, 0.5) << ","
+                    << phasePercentile(PHASE_PRESENT, 0.5) << "," << drawStats.drawCalls << "," << drawStats.vertices << "\n";
+                cout << renderModeNames[mode] << " grid " << gridSize << " option " << option << ": "
+                     << mean << " ms/frame (p95 " << percentile(0.95) << ")\n";
+            }
+        }
+    }
+
+    simulatedTime = -1.0;
+    cout << "Benchmark results written to " << outPath << "\n";
+    return 0;
 }
 
-void arrangeRandomTiles()
+Image captureFrame()
 {
-    random_device rd;
-    mt19937 gen(rd());
+    // the tile field alone, text and overlays would make the frame depend on timings
+    Vector2 startPos = {((float)w - (float)tileAtlas.tileWidth) / 2.f,
+                        (float)h / 2.f};
+    chooseFrameMode();
+    layoutTileField(startPos);
+    pickedCol = pickedRow = -1; // nor the outline, it follows the mouse
+    if (headless)
+    {
+        drawTileField();
+        return ImageCopy(softwareRenderer.frame);
+    }
 
-    float mean = floor((float)imgFilesSize / 2.f);
-    normal_distribution<float> dist(mean, stddev);
-    tileMap.resize(static_cast<unsigned long int>(gridSize * gridSize), 3);
+    BeginDrawing();
+    ClearBackground(bgColor);
+    drawTileField();
+    rlDrawRenderBatchActive(); // the batch has to reach the back buffer before reading it
+    Image frame = LoadImageFromScreen();
+    EndDrawing();
+    return frame;
+}
 
-    for (int i = 0; i < gridSize * gridSize; i++)
+int runGolden(bool record, const char *dir)
+{
+    /**
+     * Renders every (grid size, oscillation option, amplitude, std dev) combination with a fixed
+     * map seed and clock. Recording saves them as PNGs in `dir`, checking compares against those
+     * with a per channel tolerance and writes a *_diff.png next to every reference that fails.
+     */
+    if (record && !DirectoryExists(dir) && MakeDirectory(dir) != 0)
     {
+        cout << "Cannot create " << dir << "\n";
+        return -1;
+    }
 
-        double x;
-        do
+    const int gridSizes[] = GOLDEN_GRID_SIZES;
+    const float amplitudes[] = GOLDEN_AMPLITUDES;
+    const float stddevs[] = GOLDEN_STDDEVS;
+    int frames = 0, failures = 0;
+
+    long long userSeed = mapSeed;
+    mapSeed = GOLDEN_SEED;
+    simulatedTime = GOLDEN_TIME;
+    oscilSpeed = OSCIl_SPEED;
+    for (int size : gridSizes)
+    {
+        gridSize = size;
+        for (float deviation : stddevs)
         {
-            x = dist(gen);
-        } while (x < 0.0f || x > (float)(imgFilesSize)-1);
+            stddev = deviation;
+            arrangeRandomTiles();
+            for (float amp : amplitudes)
+            {
+                amplitude = amp;
+                for (unsigned short option = 1; option <= 3; option++)
+                {
+                    oscilOption = option;
+                    string name = TextFormat("%s/grid%d_sd%.1f_amp%.0f_opt%d", dir, size, deviation, amp, option);
+                    Image frame = captureFrame();
+                    frames++;
 
-        // cout << round(x) << "\n";
+                    if (record)
+                    {
+                        if (!ExportImage(frame, (name + ".png").c_str()))
+                            failures++;
+                        UnloadImage(frame);
+                        continue;
+                    }
 
-        // cout << tileMap.size() << "\t" << tileMap.capacity() << "\n";
-        tileMap.at(static_cast<unsigned long int>(i)) = int(round(x));
-        // tileMap[i] = int(round(x));
-        // tileMap.push_back(GetRandomValue(0, imgFilesSize - 1));
-        // tileMap.push_back(2);
+                    Image reference = LoadImage((name + ".png").c_str());
+                    if (!reference.data)
+                    {
+                        cout << "Missing reference " << name << ".png\n";
+                        failures++;
+                        UnloadImage(frame);
+                        continue;
+                    }
+                    Image diff = {};
+                    FrameDiff result = compareFrames(reference, frame, GOLDEN_TOLERANCE, &diff);
+                    if (!result.sizeMatches || result.mismatched > GOLDEN_MAX_MISMATCH)
+                    {
+                        failures++;
+                        cout << "FAIL " << name << ": " << (result.sizeMatches ? "" : "size differs, ")
+                             << result.mismatched << " pixels off, max delta " << result.maxDelta << "\n";
+                        if (diff.data)
+                            ExportImage(diff, (name + "_diff.png").c_str());
+                    }
+                    if (diff.data)
+                        UnloadImage(diff);
+                    UnloadImage(reference);
+                    UnloadImage(frame);
+                }
+            }
+        }
     }
-}
\ No newline at end of file
+
+    mapSeed = userSeed;
+    simulatedTime = -1.0;
+    if (record)
+        cout << "Recorded " << frames - failures << " golden frames in " << dir << "\n";
+    else
+        cout << frames - failures << "/" << frames << " golden frames match\n";
+    return failures ? 1 : 0;
+}
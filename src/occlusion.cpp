@@ -0,0 +1,166 @@
+#include "occlusion.hpp"
+
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+static void resizeProfile(TileProfile &profile, size_t width)
+{
+    profile.opaqueTop.assign(width, 0);
+    profile.opaqueBottom.assign(width, 0);
+    profile.solidTop.assign(width, 0);
+    profile.solidBottom.assign(width, 0);
+}
+
+void buildOcclusionProfiles(OcclusionBuffer &buffer, const TileAtlas &atlas)
+{
+    buffer.tiles.assign(static_cast<size_t>(max(atlas.count, 0)), {});
+    buffer.grown.clear();
+    buffer.tileWidth = atlas.tileWidth;
+    buffer.margin = -1; // grown by the first beginOcclusion()
+    const unsigned char *pixels = static_cast<const unsigned char *>(atlas.image.data);
+    if (!pixels)
+        return;
+
+    for (size_t tile = 0; tile < buffer.tiles.size(); tile++)
+    {
+        const Rectangle &rect = atlas.rects[tile];
+        int width = static_cast<int>(rect.width), height = static_cast<int>(rect.height);
+        TileProfile &profile = buffer.tiles[tile];
+        resizeProfile(profile, static_cast<size_t>(width));
+        for (int x = 0; x < width; x++)
+        {
+            int opaqueTop = height, opaqueBottom = 0, solidTop = 0, solidBottom = 0, run = -1;
+            for (int y = 0; y < height; y++)
+            {
+                size_t offset = (static_cast<size_t>(rect.y) + static_cast<size_t>(y)) * static_cast<size_t>(atlas.image.width) +
+                                static_cast<size_t>(rect.x) + static_cast<size_t>(x);
+                unsigned char alpha = pixels[offset * 4 + 3];
+                if (alpha)
+                {
+                    opaqueTop = min(opaqueTop, y);
+                    opaqueBottom = y + 1;
+                }
+                if (alpha != 255)
+                {
+                    run = -1;
+                    continue;
+                }
+                if (run < 0)
+                    run = y;
+                if (y + 1 - run > solidBottom - solidTop)
+                {
+                    solidTop = run;
+                    solidBottom = y + 1;
+                }
+            }
+            size_t i = static_cast<size_t>(x);
+            profile.opaqueTop[i] = static_cast<int16_t>(opaqueTop < opaqueBottom ? opaqueTop : 0);
+            profile.opaqueBottom[i] = static_cast<int16_t>(opaqueBottom);
+            profile.solidTop[i] = static_cast<int16_t>(solidTop);
+            profile.solidBottom[i] = static_cast<int16_t>(solidBottom);
+        }
+    }
+}
+
+// Each column of `grown` may be drawn by the columns up to `margin` away in the tile and surely is
+// by all of them, and the rows move by as much; past the tile's edges nothing is solid
+static void growProfile(const TileProfile &tile, TileProfile &grown, int margin)
+{
+    int width = static_cast<int>(tile.opaqueTop.size());
+    resizeProfile(grown, static_cast<size_t>(width + 2 * margin));
+    for (int column = 0; column < width + 2 * margin; column++)
+    {
+        int opaqueTop = INT_MAX, opaqueBottom = INT_MIN, solidTop = INT_MIN, solidBottom = INT_MAX;
+        for (int x = column - 2 * margin; x <= column; x++)
+        {
+            if (x < 0 || x >= width)
+            {
+                solidBottom = INT_MIN;
+                continue;
+            }
+            size_t i = static_cast<size_t>(x);
+            if (tile.opaqueTop[i] < tile.opaqueBottom[i])
+            {
+                opaqueTop = min(opaqueTop, (int)tile.opaqueTop[i]);
+                opaqueBottom = max(opaqueBottom, (int)tile.opaqueBottom[i]);
+            }
+            solidTop = max(solidTop, (int)tile.solidTop[i]);
+            solidBottom = min(solidBottom, (int)tile.solidBottom[i]);
+        }
+        size_t i = static_cast<size_t>(column);
+        if (opaqueTop < opaqueBottom)
+        {
+            grown.opaqueTop[i] = static_cast<int16_t>(opaqueTop - margin);
+            grown.opaqueBottom[i] = static_cast<int16_t>(opaqueBottom + margin);
+        }
+        if (solidTop + margin < solidBottom - margin)
+        {
+            grown.solidTop[i] = static_cast<int16_t>(solidTop + margin);
+            grown.solidBottom[i] = static_cast<int16_t>(solidBottom - margin);
+        }
+    }
+}
+
+void beginOcclusion(OcclusionBuffer &buffer, int diagMin, int diagMax, int lod, int margin)
+{
+    if (margin != buffer.margin)
+    {
+        buffer.grown.resize(buffer.tiles.size());
+        for (size_t tile = 0; tile < buffer.tiles.size(); tile++)
+            growProfile(buffer.tiles[tile], buffer.grown[tile], margin);
+        buffer.margin = margin;
+    }
+    buffer.lod = lod;
+    buffer.diagMin = diagMin;
+    buffer.culled = 0;
+
+    size_t columns = static_cast<size_t>(max(diagMax - diagMin, 0) * (buffer.tileWidth / 2) + buffer.tileWidth + 2 * margin);
+    buffer.coverTop.assign(columns, INT_MAX);
+    buffer.coverBottom.assign(columns, INT_MIN);
+}
+
+bool occludeTile(OcclusionBuffer &buffer, int tile, int diag, int y)
+{
+    if (tile < 0 || static_cast<size_t>(tile) >= buffer.grown.size() || diag < buffer.diagMin)
+        return false;
+    const TileProfile &profile = buffer.grown[static_cast<size_t>(tile)];
+    size_t first = static_cast<size_t>(diag - buffer.diagMin) * static_cast<size_t>(buffer.tileWidth / 2);
+    size_t count = profile.opaqueTop.size();
+    if (first + count > buffer.coverTop.size())
+        return false;
+    int *coverTop = buffer.coverTop.data() + first;
+    int *coverBottom = buffer.coverBottom.data() + first;
+    int lod = buffer.lod;
+
+    bool hidden = true;
+    for (size_t i = 0; i < count && hidden; i++)
+        if (profile.opaqueTop[i] < profile.opaqueBottom[i])
+            hidden = y + profile.opaqueTop[i] * lod >= coverTop[i] && y + profile.opaqueBottom[i] * lod <= coverBottom[i];
+    if (hidden)
+    {
+        buffer.culled++;
+        return true;
+    }
+
+    // one interval per column: the tile's solid rows join it when they touch, otherwise the upper one is kept
+    // (the tiles still to come are further back, higher up the screen)
+    for (size_t i = 0; i < count; i++)
+    {
+        if (profile.solidTop[i] >= profile.solidBottom[i])
+            continue;
+        int top = y + profile.solidTop[i] * lod, bottom = y + profile.solidBottom[i] * lod;
+        if (coverTop[i] < coverBottom[i] && top <= coverBottom[i] && bottom >= coverTop[i])
+        {
+            coverTop[i] = min(coverTop[i], top);
+            coverBottom[i] = max(coverBottom[i], bottom);
+        }
+        else if (coverTop[i] >= coverBottom[i] || top < coverTop[i])
+        {
+            coverTop[i] = top;
+            coverBottom[i] = bottom;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "atlas.hpp"
+
+// Rows of every texel column of a tile image, [top, bottom) with top >= bottom for none
+struct TileProfile
+{
+    std::vector<int16_t> opaqueTop;    // first to last pixel with any alpha, what drawing the tile can touch
+    std::vector<int16_t> opaqueBottom;
+    std::vector<int16_t> solidTop;     // longest run of fully opaque pixels, what drawing the tile surely paints over
+    std::vector<int16_t> solidBottom;
+};
+
+/**
+ * Screen-space occlusion for tiles drawn back to front: they are tested front to back against the rows
+ * every column of the field already has covered by the tiles in front of them (drawn after them), a horizon
+ * with a lower edge. Columns are texels of a tile at the lod drawn, tiles of one diagonal (col - row) share
+ * theirs and the next diagonal is half a tile to the right, so no column ever falls between two tiles.
+ */
+struct OcclusionBuffer
+{
+    std::vector<TileProfile> tiles; // as packed in the atlas
+    std::vector<TileProfile> grown; // widened by margin texels on every side, the solid rows narrowed by as much
+    int tileWidth;
+    int margin;                     // texels the profiles are grown by, for tiles landing a pixel or two off their place
+    int lod;                        // a texel is lod world pixels
+    int diagMin;                    // diagonal whose tiles start at column margin
+    std::vector<int> coverTop;      // per column, world rows [coverTop, coverBottom) tiles already tested paint over
+    std::vector<int> coverBottom;
+    int culled;                     // tiles occludeTile() found covered since beginOcclusion()
+};
+
+void buildOcclusionProfiles(OcclusionBuffer &buffer, const TileAtlas &atlas);
+void beginOcclusion(OcclusionBuffer &buffer, int diagMin, int diagMax, int lod, int margin); // empty horizon for tiles of these diagonals
+bool occludeTile(OcclusionBuffer &buffer, int tile, int diag, int y); // y: top of the tile in world pixels; false adds it to the horizon
@@ -0,0 +1,99 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "definitions.hpp"
+#include "stats.hpp"
+
+using namespace std;
+using ProfilerClock = chrono::steady_clock; // monotonic, nanosecond resolution on the platforms we build for
+
+static const char *phaseNames[PHASE_COUNT] = {"Events", "Altitude", "Tiles", "Text", "Present", "Overlay"};
+
+static ProfilerClock::time_point phaseStart[PHASE_COUNT];
+static double frameTimes[PHASE_COUNT];                 // ms spent in each phase during the current frame
+static double window[PHASE_COUNT][PROFILER_WINDOW];    // ms of the last PROFILER_WINDOW frames
+static int windowHead = 0;
+static int windowFilled = 0;
+
+void beginPhase(FramePhase phase)
+{
+    phaseStart[phase] = ProfilerClock::now();
+}
+
+void endPhase(FramePhase phase)
+{
+    frameTimes[phase] += chrono::duration<double, milli>(ProfilerClock::now() - phaseStart[phase]).count();
+}
+
+void endProfilerFrame()
+{
+    frameTimes[PHASE_TILES] = max(0.0, frameTimes[PHASE_TILES] - frameTimes[PHASE_ALTITUDE]); // altitude runs inside the tile pass
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        window[phase][windowHead] = frameTimes[phase];
+        frameTimes[phase] = 0.0;
+    }
+    windowHead = (windowHead + 1) % PROFILER_WINDOW;
+    windowFilled = min(windowFilled + 1, PROFILER_WINDOW);
+}
+
+void resetProfiler()
+{
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+        frameTimes[phase] = 0.0;
+    windowHead = 0;
+    windowFilled = 0;
+}
+
+double phasePercentile(FramePhase phase, double p)
+{
+    if (windowFilled == 0)
+        return 0.0;
+
+    double sorted[PROFILER_WINDOW];
+    copy(window[phase], window[phase] + windowFilled, sorted);
+    int k = min(windowFilled - 1, static_cast<int>(p * (windowFilled - 1) + 0.5));
+    nth_element(sorted, sorted + k, sorted + windowFilled);
+    return sorted[k];
+}
+
+static void overlayLine(const char *text, int x, int y, Color color)
+{
+    DrawText(text, x, y, 10, color);
+    countDraw(GetFontDefault().texture.id, 4 * (int)TextLength(text));
+}
+
+void drawProfilerOverlay(int x, int y, Color color)
+{
+    beginPhase(PHASE_OVERLAY);
+
+    int lineHeight = 12;
+    overlayLine(TextFormat("%-9s %7s %7s %7s  (ms, last %d frames)", "Phase", "p50", "p95", "p99", windowFilled), x, y, color);
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        FramePhase ph = FramePhase(phase);
+        overlayLine(TextFormat("%-9s %7.3f %7.3f %7.3f", phaseNames[phase], phasePercentile(ph, 0.50), phasePercentile(ph, 0.95), phasePercentile(ph, 0.99)),
+                    x, y + lineHeight * (phase + 1), color);
+    }
+    overlayLine(TextFormat("Draw calls: %d  Vertices: %d  Texture switches: %d  Hidden: %d  Occluded: %d", lastDrawStats.drawCalls, lastDrawStats.vertices,
+                           lastDrawStats.textureSwitches, lastDrawStats.hiddenTiles, lastDrawStats.occludedTiles),
+                x, y + lineHeight * (PHASE_COUNT + 1), color);
+    overlayLine(TextFormat("Tile map: %d B/tile (%.2f padded)  %.1f MiB now  %.0f MiB at 4096^2  %.0f MiB at 16384^2", (int)memoryStats.bytesPerTile,
+                           (double)memoryStats.paddedBytesPerTile, (double)memoryStats.tileMapBytes / 1048576.0, (double)memoryStats.bytesAt4096 / 1048576.0, (double)memoryStats.bytesAt16384 / 1048576.0),
+                x, y + lineHeight * (PHASE_COUNT + 2), color);
+    int line = PHASE_COUNT + 3;
+    if (lastDrawStats.framePixels)
+        overlayLine(TextFormat("Redrawn: %d regions  %.1f%% of the frame", lastDrawStats.redrawRegions,
+                               100.0 * lastDrawStats.redrawPixels / lastDrawStats.framePixels),
+                    x, y + lineHeight * line++, color);
+    if (memoryStats.voxelColumns)
+        overlayLine(TextFormat("Stacks: %d columns  %.1f MiB", (int)memoryStats.voxelColumns, (double)memoryStats.voxelBytes / 1048576.0), x, y + lineHeight * line++, color);
+    if (memoryStats.worldChunks || memoryStats.worldPending)
+        overlayLine(TextFormat("World: %d chunks  %.1f MiB  %d generating", memoryStats.worldChunks, (double)memoryStats.worldBytes / 1048576.0, memoryStats.worldPending),
+                    x, y + lineHeight * line, color);
+
+    endPhase(PHASE_OVERLAY);
+}
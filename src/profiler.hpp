@@ -0,0 +1,22 @@
+#pragma once
+
+#include <raylib.h>
+
+// Parts of a frame that are timed separately
+enum FramePhase
+{
+    PHASE_EVENTS = 0, // handleEvents()
+    PHASE_ALTITUDE,   // altitude field evaluation (nested in the tile pass, reported apart from it)
+    PHASE_TILES,      // tile submission in drawGame()
+    PHASE_TEXT,       // drawText()
+    PHASE_PRESENT,    // EndDrawing(): batch flush, swap and the frame limiter wait
+    PHASE_OVERLAY,    // drawing this overlay
+    PHASE_COUNT
+};
+
+void beginPhase(FramePhase phase);
+void endPhase(FramePhase phase);  // time adds up if a phase is entered several times a frame
+void endProfilerFrame();          // pushes the frame into the rolling window
+void resetProfiler();             // forgets the rolling window
+double phasePercentile(FramePhase phase, double p); // milliseconds, p in [0, 1]
+void drawProfilerOverlay(int x, int y, Color color);
@@ -0,0 +1,26 @@
+#include "random.hpp"
+
+#include <random>
+
+using namespace std;
+
+void seedRng(Pcg32 &rng, uint64_t seed, uint64_t stream)
+{
+    rng.state = 0;
+    rng.inc = (stream << 1u) | 1u;
+    nextU32(rng);
+    rng.state += seed;
+    nextU32(rng);
+}
+
+uint64_t entropySeed()
+{
+    static Pcg32 source = []
+    {
+        random_device rd;
+        Pcg32 rng;
+        seedRng(rng, (uint64_t(rd()) << 32) | rd());
+        return rng;
+    }();
+    return (uint64_t(nextU32(source)) << 32) | nextU32(source);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * PCG32 (XSH-RR variant): 16 bytes of state, a handful of instructions per number and the same
+ * sequence on every platform for a given seed, unlike mt19937 + <random> distributions.
+ */
+struct Pcg32
+{
+    uint64_t state;
+    uint64_t inc; // stream selector, always odd
+};
+
+void seedRng(Pcg32 &rng, uint64_t seed, uint64_t stream = 0);
+uint64_t entropySeed(); // fresh seed for unseeded runs, random_device is only read once
+
+inline uint32_t nextU32(Pcg32 &rng)
+{
+    uint64_t old = rng.state;
+    rng.state = old * 6364136223846793005ULL + rng.inc;
+    uint32_t xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = static_cast<uint32_t>(old >> 59u);
+    return (xorShifted >> rot) | (xorShifted << ((-rot) & 31u));
+}
+
+// Counter-based: the random bits of a map cell only depend on (seed, x, y), not on visiting order or threads
+inline uint64_t hashCoords(uint64_t seed, uint32_t x, uint32_t y)
+{
+    uint64_t z = seed + ((static_cast<uint64_t>(y) << 32) | x) * 0x9E3779B97F4A7C15ULL; // SplitMix64 finaliser
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline float nextFloat(Pcg32 &rng) // [0, 1)
+{
+    return static_cast<float>(nextU32(rng) >> 8) * (1.f / 16777216.f);
+}
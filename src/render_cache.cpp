@@ -0,0 +1,61 @@
+#include "render_cache.hpp"
+
+#include "stats.hpp"
+
+static bool sameKey(const RenderCacheKey &a, const RenderCacheKey &b)
+{
+    return a.gridSize == b.gridSize &&
+           a.stddev == b.stddev &&
+           a.tileMapVersion == b.tileMapVersion &&
+           a.width == b.width &&
+           a.height == b.height &&
+           a.amplitude == b.amplitude &&
+           a.oscilSpeed == b.oscilSpeed &&
+           a.oscilOption == b.oscilOption &&
+           a.renderMode == b.renderMode &&
+           a.cameraTarget.x == b.cameraTarget.x &&
+           a.cameraTarget.y == b.cameraTarget.y &&
+           a.cameraZoom == b.cameraZoom;
+}
+
+bool renderCacheValid(const RenderCache &cache, const RenderCacheKey &key)
+{
+    return cache.valid && sameKey(cache.key, key);
+}
+
+void beginRenderCache(RenderCache &cache, const RenderCacheKey &key, Color background)
+{
+    if (cache.target.id == 0 || cache.target.texture.width != key.width || cache.target.texture.height != key.height)
+    {
+        unloadRenderCache(cache);
+        cache.target = LoadRenderTexture(key.width, key.height);
+    }
+
+    cache.key = key;
+    cache.valid = false;
+    BeginTextureMode(cache.target); // flushes whatever was batched for the screen
+    countFlush();
+    ClearBackground(background);
+}
+
+void endRenderCache(RenderCache &cache)
+{
+    EndTextureMode();
+    countFlush();
+    cache.valid = cache.target.id != 0;
+}
+
+void drawRenderCache(const RenderCache &cache)
+{
+    // render textures are stored upside down
+    Rectangle source = {0, 0, (float)cache.target.texture.width, -(float)cache.target.texture.height};
+    DrawTextureRec(cache.target.texture, source, {0, 0}, WHITE);
+    countDraw(cache.target.texture.id, 4);
+}
+
+void unloadRenderCache(RenderCache &cache)
+{
+    if (cache.target.id)
+        UnloadRenderTexture(cache.target);
+    cache = {};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <raylib.h>
+
+// Everything the tile pass depends on when the scene does not animate
+struct RenderCacheKey
+{
+    int gridSize;
+    float stddev;
+    unsigned int tileMapVersion;
+    int width;
+    int height;
+    float amplitude;
+    float oscilSpeed;
+    unsigned short oscilOption;
+    int renderMode;
+    Vector2 cameraTarget;
+    float cameraZoom;
+};
+
+// Tile pass rendered once into a texture and blitted while the key stays the same
+struct RenderCache
+{
+    RenderTexture2D target;
+    RenderCacheKey key;
+    bool valid;
+};
+
+bool renderCacheValid(const RenderCache &cache, const RenderCacheKey &key);
+void beginRenderCache(RenderCache &cache, const RenderCacheKey &key, Color background); // following draws go into the cache
+void endRenderCache(RenderCache &cache);
+void drawRenderCache(const RenderCache &cache);
+void unloadRenderCache(RenderCache &cache);
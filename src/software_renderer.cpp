@@ -0,0 +1,268 @@
+#include "software_renderer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "definitions.hpp"
+#include "stats.hpp"
+
+using namespace std;
+
+void initSoftwareRenderer(SoftwareRenderer &renderer, const TileAtlas &atlas)
+{
+    renderer = {};
+    renderer.atlas = &atlas;
+}
+
+void unloadSoftwareRenderer(SoftwareRenderer &renderer)
+{
+    if (renderer.texture.id)
+        UnloadTexture(renderer.texture);
+    if (renderer.frame.data)
+        UnloadImage(renderer.frame);
+    renderer = {};
+}
+
+static bool sameColor(Color a, Color b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+void beginSoftwareFrame(SoftwareRenderer &renderer, int width, int height, Color background, Color tint)
+{
+    if (!renderer.frame.data || renderer.frame.width != width || renderer.frame.height != height)
+    {
+        if (renderer.frame.data)
+            UnloadImage(renderer.frame);
+        renderer.frame = GenImageColor(width, height, background);
+        renderer.frameValid = false;
+    }
+    if (!sameColor(renderer.background, background) || !sameColor(renderer.tint, tint))
+        renderer.frameValid = false;
+    renderer.background = background;
+    renderer.tint = tint;
+    renderer.tiles.clear();
+}
+
+void pushSoftwareTile(SoftwareRenderer &renderer, int x, int y, int tile, float scale)
+{
+    const Rectangle &rect = renderer.atlas->rects[tile];
+    int width = max(1, (int)(rect.width * scale));
+    int height = max(1, (int)(rect.height * scale));
+    renderer.tiles.push_back({x, y, tile, width, height});
+}
+
+static inline unsigned char blendChannel(unsigned int src, unsigned int dst, unsigned int alpha)
+{
+    return static_cast<unsigned char>((src * alpha + dst * (255 - alpha) + 127) / 255);
+}
+
+// Draws every tile that overlaps the region, in submission order
+static void rasterRegion(SoftwareRenderer &renderer, SoftwareRect region)
+{
+    const Image &frame = renderer.frame;
+    const Image &atlasImg = renderer.atlas->image;
+    unsigned char *dstPixels = static_cast<unsigned char *>(frame.data);
+    const unsigned char *atlasPixels = static_cast<const unsigned char *>(atlasImg.data);
+    const Color bg = renderer.background;
+    const Color tint = renderer.tint;
+    const bool plainTint = tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255;
+
+    for (int y = region.y0; y < region.y1; y++)
+    {
+        unsigned char *row = dstPixels + static_cast<size_t>(y) * static_cast<size_t>(frame.width) * 4;
+        for (int x = region.x0; x < region.x1; x++)
+        {
+            row[x * 4 + 0] = bg.r;
+            row[x * 4 + 1] = bg.g;
+            row[x * 4 + 2] = bg.b;
+            row[x * 4 + 3] = bg.a;
+        }
+    }
+
+    for (const SoftwareTile &tile : renderer.tiles)
+    {
+        const Rectangle &rect = renderer.atlas->rects[tile.tile];
+        int tileW = static_cast<int>(rect.width);
+        int tileH = static_cast<int>(rect.height);
+        int top = max(tile.y, region.y0);
+        int bottom = min(tile.y + tile.height, region.y1);
+        int left = max(tile.x, region.x0);
+        int right = min(tile.x + tile.width, region.x1);
+        if (top >= bottom || left >= right)
+            continue;
+
+        // source pixels per destination pixel in 16.16 fixed point, exactly one step when not scaled
+        unsigned int stepX = (static_cast<unsigned int>(tileW) << 16) / static_cast<unsigned int>(tile.width);
+        unsigned int firstX = static_cast<unsigned int>(left - tile.x) * stepX;
+        for (int y = top; y < bottom; y++)
+        {
+            int srcY = (y - tile.y) * tileH / tile.height;
+            const unsigned char *srcRow = atlasPixels + (static_cast<size_t>(rect.y) + static_cast<size_t>(srcY)) * static_cast<size_t>(atlasImg.width) * 4 +
+                                          static_cast<size_t>(rect.x) * 4;
+            unsigned char *dst = dstPixels + (static_cast<size_t>(y) * static_cast<size_t>(frame.width) + static_cast<size_t>(left)) * 4;
+            unsigned int srcX = firstX;
+            for (int x = left; x < right; x++, srcX += stepX, dst += 4)
+            {
+                const unsigned char *src = srcRow + (srcX >> 16) * 4;
+                unsigned int r = src[0], g = src[1], b = src[2], a = src[3];
+                if (!plainTint)
+                {
+                    r = r * tint.r / 255;
+                    g = g * tint.g / 255;
+                    b = b * tint.b / 255;
+                    a = a * tint.a / 255;
+                }
+                if (a == 0)
+                    continue;
+                if (a == 255)
+                {
+                    dst[0] = static_cast<unsigned char>(r);
+                    dst[1] = static_cast<unsigned char>(g);
+                    dst[2] = static_cast<unsigned char>(b);
+                    dst[3] = 255;
+                    continue;
+                }
+                // same blending rlgl sets up by default (SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+                dst[0] = blendChannel(r, dst[0], a);
+                dst[1] = blendChannel(g, dst[1], a);
+                dst[2] = blendChannel(b, dst[2], a);
+                dst[3] = blendChannel(a, dst[3], a);
+            }
+        }
+    }
+}
+
+static bool sameTile(const SoftwareTile &a, const SoftwareTile &b)
+{
+    return a.x == b.x && a.y == b.y && a.tile == b.tile && a.width == b.width && a.height == b.height;
+}
+
+// Fills renderer.dirty: the whole frame, or the squares the tiles that differ from the last frame touch
+static void findDirtyRegions(SoftwareRenderer &renderer)
+{
+    const int cell = SOFTWARE_BAND_HEIGHT;
+    int width = renderer.frame.width, height = renderer.frame.height;
+    renderer.dirty.clear();
+    if (!renderer.incremental || !renderer.frameValid)
+    {
+        renderer.dirty.push_back({0, 0, width, height});
+        return;
+    }
+
+    int cols = (width + cell - 1) / cell, rows = (height + cell - 1) / cell;
+    vector<unsigned char> &cells = renderer.dirtyCells;
+    cells.assign(static_cast<size_t>(cols) * static_cast<size_t>(rows), 0);
+    auto mark = [&](const SoftwareTile &tile)
+    {
+        int x0 = max(tile.x, 0), x1 = min(tile.x + tile.width, width);
+        int y0 = max(tile.y, 0), y1 = min(tile.y + tile.height, height);
+        if (x0 >= x1 || y0 >= y1)
+            return;
+        for (int row = y0 / cell; row <= (y1 - 1) / cell; row++)
+            fill_n(cells.begin() + row * cols + x0 / cell, (x1 - 1) / cell - x0 / cell + 1, 1);
+    };
+    size_t common = min(renderer.tiles.size(), renderer.drawn.size());
+    for (size_t i = 0; i < common; i++)
+        if (!sameTile(renderer.tiles[i], renderer.drawn[i]))
+        {
+            mark(renderer.drawn[i]);
+            mark(renderer.tiles[i]);
+        }
+    for (size_t i = common; i < renderer.tiles.size(); i++)
+        mark(renderer.tiles[i]);
+    for (size_t i = common; i < renderer.drawn.size(); i++)
+        mark(renderer.drawn[i]);
+
+    // runs of marked squares along each row; a run spanning the same columns as a region ending on the
+    // row above extends it, so a moving tile costs one region rather than one per row of squares
+    vector<size_t> above, current; // regions ending on the previous / this row, left to right
+    for (int row = 0; row < rows; row++)
+    {
+        int y0 = row * cell, y1 = min(y0 + cell, height);
+        const unsigned char *marks = cells.data() + row * cols;
+        size_t next = 0;
+        current.clear();
+        for (int col = 0; col < cols;)
+        {
+            if (!marks[col])
+            {
+                col++;
+                continue;
+            }
+            int first = col;
+            while (col < cols && marks[col])
+                col++;
+            int x0 = first * cell, x1 = min(col * cell, width);
+            while (next < above.size() && renderer.dirty[above[next]].x0 < x0)
+                next++;
+            if (next < above.size() && renderer.dirty[above[next]].x0 == x0 && renderer.dirty[above[next]].x1 == x1)
+            {
+                renderer.dirty[above[next]].y1 = y1;
+                current.push_back(above[next]);
+            }
+            else
+            {
+                renderer.dirty.push_back({x0, y0, x1, y1});
+                current.push_back(renderer.dirty.size() - 1);
+            }
+        }
+        swap(above, current);
+    }
+}
+
+void renderSoftwareFrame(SoftwareRenderer &renderer, ThreadPool &pool)
+{
+    findDirtyRegions(renderer);
+
+    // regions cut at band boundaries; they never overlap, so neither do the pieces the workers draw
+    static vector<SoftwareRect> pieces;
+    pieces.clear();
+    int pixels = 0;
+    for (const SoftwareRect &region : renderer.dirty)
+    {
+        for (int y0 = region.y0; y0 < region.y1; y0 = (y0 / SOFTWARE_BAND_HEIGHT + 1) * SOFTWARE_BAND_HEIGHT)
+            pieces.push_back({region.x0, y0, region.x1, min((y0 / SOFTWARE_BAND_HEIGHT + 1) * SOFTWARE_BAND_HEIGHT, region.y1)});
+        pixels += (region.x1 - region.x0) * (region.y1 - region.y0);
+    }
+    pool.parallelFor(static_cast<int>(pieces.size()), [&](int piece)
+                     { rasterRegion(renderer, pieces[static_cast<size_t>(piece)]); });
+
+    renderer.drawn.assign(renderer.tiles.begin(), renderer.tiles.end());
+    renderer.frameValid = true;
+    renderer.unpresented++;
+    drawStats.redrawRegions += static_cast<int>(renderer.dirty.size());
+    drawStats.redrawPixels += pixels;
+    drawStats.framePixels += renderer.frame.width * renderer.frame.height;
+}
+
+void presentSoftwareFrame(SoftwareRenderer &renderer)
+{
+    if (!renderer.texture.id || renderer.texture.width != renderer.frame.width || renderer.texture.height != renderer.frame.height)
+    {
+        if (renderer.texture.id)
+            UnloadTexture(renderer.texture);
+        renderer.texture = LoadTextureFromImage(renderer.frame);
+    }
+    else if (renderer.unpresented > 1)
+        UpdateTexture(renderer.texture, renderer.frame.data); // regions of the renders in between were never uploaded
+    else if (renderer.unpresented == 1)
+    {
+        size_t stride = static_cast<size_t>(renderer.frame.width) * 4;
+        const unsigned char *pixels = static_cast<const unsigned char *>(renderer.frame.data);
+        for (const SoftwareRect &region : renderer.dirty)
+        {
+            size_t rowBytes = static_cast<size_t>(region.x1 - region.x0) * 4;
+            renderer.upload.resize(rowBytes * static_cast<size_t>(region.y1 - region.y0));
+            for (int y = region.y0; y < region.y1; y++)
+                memcpy(renderer.upload.data() + static_cast<size_t>(y - region.y0) * rowBytes,
+                       pixels + static_cast<size_t>(y) * stride + static_cast<size_t>(region.x0) * 4, rowBytes);
+            UpdateTextureRec(renderer.texture, {(float)region.x0, (float)region.y0, (float)(region.x1 - region.x0), (float)(region.y1 - region.y0)},
+                             renderer.upload.data());
+        }
+    }
+    renderer.unpresented = 0;
+
+    DrawTexture(renderer.texture, 0, 0, WHITE);
+    countDraw(renderer.texture.id, 4);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <vector>
+
+#include "atlas.hpp"
+#include "thread_pool.hpp"
+
+// Tile sprite waiting to be rasterised, at its truncated screen position and size
+struct SoftwareTile
+{
+    int x;
+    int y;
+    int tile;
+    int width; // the atlas rectangle is scaled to this (nearest neighbour)
+    int height;
+};
+
+// Pixels [x0, x1) x [y0, y1) of the frame
+struct SoftwareRect
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+/**
+ * Rasterises the tile field into an Image on the CPU, bands of the frame are spread over a thread pool.
+ * The frame persists between frames: incrementally, only the squares of it that a tile which moved,
+ * changed, came or went since the last frame touches are redrawn (every tile submitted at the same
+ * pixel leaves the rest of the frame exactly as it was), merged into a few rectangles. Only this renderer
+ * does so; drawTile() lands tiles on whole pixels as well, but the GPU modes redraw the field every frame.
+ */
+struct SoftwareRenderer
+{
+    Image frame;                      // RGBA8 render target
+    const TileAtlas *atlas;           // tile pixels are read from atlas->image
+    Texture texture;                  // frame uploaded for display, 0 when running headless
+    std::vector<SoftwareTile> tiles;  // submission order is draw order
+    std::vector<SoftwareTile> drawn;  // tiles the frame was last rendered from
+    std::vector<unsigned char> dirtyCells; // SOFTWARE_BAND_HEIGHT squares of the frame to redraw, row-major
+    std::vector<SoftwareRect> dirty;  // regions the last render redrew, disjoint
+    std::vector<unsigned char> upload; // one region's rows packed for the texture
+    bool incremental;                 // redraw only where tiles changed, otherwise the whole frame every time
+    bool frameValid;                  // frame holds `drawn`, false once it is reallocated or recoloured
+    int unpresented;                  // renders since the texture was updated, past one it takes the whole frame
+    Color background;
+    Color tint;
+};
+
+void initSoftwareRenderer(SoftwareRenderer &renderer, const TileAtlas &atlas);
+void unloadSoftwareRenderer(SoftwareRenderer &renderer);
+void beginSoftwareFrame(SoftwareRenderer &renderer, int width, int height, Color background, Color tint);
+void pushSoftwareTile(SoftwareRenderer &renderer, int x, int y, int tile, float scale = 1.f);
+void renderSoftwareFrame(SoftwareRenderer &renderer, ThreadPool &pool);
+void presentSoftwareFrame(SoftwareRenderer &renderer); // uploads the regions redrawn and draws the frame, needs a window
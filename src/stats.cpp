@@ -0,0 +1,59 @@
+#include "stats.hpp"
+
+#include <rlgl.h>
+
+DrawStats drawStats = {};
+DrawStats lastDrawStats = {};
+MemoryStats memoryStats = {};
+
+static bool batchOpen = false;        // false right after a flush, the next draw starts a new call
+static unsigned int batchTexture = 0; // texture of the draw call currently being filled
+static int batchVertices = 0;         // vertices in the current rlgl vertex buffer
+
+/**
+ * rlgl does not expose its draw counter, so the batching rules are mirrored here:
+ * a new draw call starts whenever the texture changes or the internal vertex
+ * buffer (RL_DEFAULT_BATCH_BUFFER_ELEMENTS quads) overflows and gets flushed.
+ */
+void resetDrawStats()
+{
+    lastDrawStats = drawStats;
+    drawStats = {};
+    countFlush();
+}
+
+void countDraw(unsigned int textureId, int vertexCount)
+{
+    if (!batchOpen)
+    {
+        drawStats.drawCalls++;
+        batchOpen = true;
+    }
+    else if (batchVertices + vertexCount > RL_DEFAULT_BATCH_BUFFER_ELEMENTS * 4)
+    {
+        drawStats.drawCalls++; // buffer flushed, draw continues in a fresh one
+        batchVertices = 0;
+    }
+    else if (textureId != batchTexture)
+    {
+        drawStats.drawCalls++;
+        drawStats.textureSwitches++;
+    }
+
+    batchTexture = textureId;
+    batchVertices += vertexCount;
+    drawStats.vertices += vertexCount;
+}
+
+void countFlush()
+{
+    batchOpen = false;
+    batchVertices = 0;
+}
+
+void countDirectDraw(int vertexCount)
+{
+    drawStats.drawCalls++;
+    drawStats.vertices += vertexCount;
+    countFlush();
+}
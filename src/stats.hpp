@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// Per-frame rendering counters
+struct DrawStats
+{
+    int drawCalls;       // draw calls rlgl issues for the frame
+    int vertices;        // vertices submitted to rlgl
+    int textureSwitches; // times the bound texture changed
+    int hiddenTiles;     // stacked tiles skipped because the layer above and the neighbours in front cover them
+    int occludedTiles;   // tiles skipped because the tiles drawn after them cover them on screen
+    int redrawRegions;   // software frame: merged regions redrawn around the tiles that changed
+    int redrawPixels;    // their area
+    int framePixels;     // area of the software frame, 0 when nothing was rendered on the CPU
+};
+
+// Footprint of the tile store, refreshed whenever the map changes
+struct MemoryStats
+{
+    size_t bytesPerTile;      // over all layers the map carries
+    float paddedBytesPerTile; // what a tile in use takes once the Morton padding of the current size is shared out
+    size_t tileMapBytes;      // allocated right now
+    size_t bytesAt4096;       // same layers at 4096x4096, padding included
+    size_t bytesAt16384;      // same layers at 16384x16384, padding included
+    int worldChunks;     // generated chunks of the streaming world in memory
+    size_t worldBytes;
+    int worldPending;    // world chunks being generated
+    size_t voxelColumns; // cells with tiles stacked on them
+    size_t voxelBytes;
+};
+
+extern DrawStats drawStats;     // frame being recorded
+extern DrawStats lastDrawStats; // last completed frame (what the text overlay shows)
+extern MemoryStats memoryStats;
+
+void resetDrawStats();                                 // call once per frame, before anything is drawn
+void countDraw(unsigned int textureId, int vertexCount); // call for every quad/glyph batch handed to rlgl
+void countFlush();                                     // call whenever the rlgl batch is flushed by hand
+void countDirectDraw(int vertexCount);                 // draw issued straight from a vertex array, outside the rlgl batch
@@ -0,0 +1,109 @@
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
+#if defined(PLATFORM_WEB)
+    threads = 1; // the web build is compiled without pthreads
+#endif
+    for (unsigned int i = 0; i + 1 < threads; i++) // the caller of parallelFor() is the last worker
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;)
+    {
+        function<void()> task;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]
+                      { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    if (workers.empty())
+    {
+        task(); // nobody else would ever pick it up
+        return;
+    }
+    {
+        lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int)> &job)
+{
+    if (count <= 0)
+        return;
+
+    // shared with helpers that may only get scheduled after this call returned
+    struct Batch
+    {
+        atomic<int> next{0};
+        atomic<int> done{0};
+        int count = 0;
+        const function<void(int)> *job = nullptr;
+        std::mutex mutex;
+        condition_variable finished;
+    };
+    auto batch = make_shared<Batch>();
+    batch->count = count;
+    batch->job = &job;
+
+    auto run = [](Batch &b)
+    {
+        for (int i = b.next.fetch_add(1); i < b.count; i = b.next.fetch_add(1))
+        {
+            (*b.job)(i);
+            if (b.done.fetch_add(1) + 1 == b.count)
+            {
+                lock_guard<std::mutex> lock(b.mutex);
+                b.finished.notify_all();
+            }
+        }
+    };
+
+    int helpers = min(count - 1, static_cast<int>(workers.size()));
+    for (int i = 0; i < helpers; i++)
+        submit([batch, run]
+               { run(*batch); });
+
+    run(*batch);
+    unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&]
+                         { return batch->done.load() == count; });
+}
+
+ThreadPool &workerPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the CPU-heavy parts of the program
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned int threads = 0); // 0: one per hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Runs job(0) ... job(count - 1) and returns once all are done. The calling thread works too,
+    // so this never waits on background tasks queued ahead of it.
+    void parallelFor(int count, const std::function<void(int)> &job);
+
+    void submit(std::function<void()> task); // fire and forget
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; } // workers + caller
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+ThreadPool &workerPool(); // created on first use
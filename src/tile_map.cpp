@@ -0,0 +1,139 @@
+#include "tile_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "definitions.hpp"
+#include "random.hpp"
+
+using namespace std;
+
+vector<double> normalTileWeights(int tileCount, float stddev)
+{
+    vector<double> weights(static_cast<size_t>(max(tileCount, 0)), 0.0);
+    if (tileCount <= 0)
+        return weights;
+
+    double mean = floor((double)tileCount / 2.0);
+    if (stddev <= 0.f || tileCount == 1)
+    {
+        weights[static_cast<size_t>(mean)] = 1.0; // a zero spread always gives the middle tile
+        return weights;
+    }
+
+    // tile i collects [i - 0.5, i + 0.5), the outer two only up to the rejection bounds 0 and tileCount - 1
+    double maxIndex = (double)(tileCount - 1);
+    auto cdf = [&](double x)
+    { return 0.5 * erfc(-(x - mean) / ((double)stddev * sqrt(2.0))); };
+    for (int i = 0; i < tileCount; i++)
+    {
+        double lo = max((double)i - 0.5, 0.0);
+        double hi = min((double)i + 0.5, maxIndex);
+        weights[static_cast<size_t>(i)] = max(cdf(hi) - cdf(lo), 0.0);
+    }
+    return weights;
+}
+
+// Draws the tiles of columns [colBegin, colEnd) in rows [rowBegin, rowEnd), one row of chunks per job
+static void fillTiles(TileMap &map, int colBegin, int colEnd, int rowBegin, int rowEnd, const AliasTable &sampler, ThreadPool &pool)
+{
+    if (colEnd <= colBegin || rowEnd <= rowBegin)
+        return;
+    const int mask = TILE_CHUNK_SIZE - 1;
+    int firstChunkRow = rowBegin >> TILE_CHUNK_SHIFT;
+    int jobs = ((rowEnd - 1) >> TILE_CHUNK_SHIFT) - firstChunkRow + 1;
+
+    pool.parallelFor(jobs, [&](int job)
+                     {
+                         AliasTable table = sampler; // private copy, the byte stores below could otherwise alias its arrays
+                         int chunkRow = firstChunkRow + job;
+                         int first = max(rowBegin, chunkRow << TILE_CHUNK_SHIFT);
+                         int last = min(rowEnd, (chunkRow + 1) << TILE_CHUNK_SHIFT);
+                         for (int chunkCol = colBegin >> TILE_CHUNK_SHIFT; chunkCol <= (colEnd - 1) >> TILE_CHUNK_SHIFT; chunkCol++)
+                         {
+                             TileId *chunk = map.ids.data() + chunkOffset(chunkCol, chunkRow);
+                             int left = max(colBegin, chunkCol << TILE_CHUNK_SHIFT);
+                             int right = min(colEnd, (chunkCol + 1) << TILE_CHUNK_SHIFT);
+                             for (int row = first; row < last; row++)
+                             {
+                                 TileId *out = chunk + ((row & mask) << TILE_CHUNK_SHIFT);
+                                 for (int col = left; col < right; col++)
+                                     out[col & mask] = (TileId)sampleAlias(table, hashCoords(map.seed, static_cast<uint32_t>(col), static_cast<uint32_t>(row)));
+                             }
+                         } });
+}
+
+// Chunks sit in Morton order, so the layer runs up to the last chunk's code and the gaps of codes past the
+// map's edges are allocated too. That is nothing when the map is a power of two of chunks and nearly 3x just
+// past one: 1025 tiles (33 x 33 chunks, 1089 needed) takes 3073. The padding buys slots that do not depend
+// on the map's size, so resizing is an append and never moves a tile; the memory stats count it, see tileMapBytesAt()
+size_t tileMapSlots(int size)
+{
+    if (size <= 0)
+        return 0;
+    int lastChunk = (size - 1) >> TILE_CHUNK_SHIFT;
+    return chunkOffset(lastChunk, lastChunk) + static_cast<size_t>(TILE_CHUNK_SIZE * TILE_CHUNK_SIZE);
+}
+
+void generateTileMap(TileMap &map, int size, const AliasTable &sampler, uint64_t seed, ThreadPool &pool)
+{
+    size_t slots = tileMapSlots(size);
+    map.size = size;
+    map.generated = size;
+    map.seed = seed;
+    map.ids.resize(slots);
+    if (!map.heights.empty())
+        map.heights.assign(slots, 0);
+    if (!map.flags.empty())
+        map.flags.assign(slots, TILE_FLAG_NONE);
+    fillTiles(map, 0, size, 0, size, sampler, pool);
+}
+
+void resizeTileMap(TileMap &map, int size, const AliasTable &sampler, ThreadPool &pool)
+{
+    size_t slots = tileMapSlots(size);
+    if (slots > map.ids.size())
+    {
+        // slots only depend on (col, row), so growing is an append; vector grows geometrically
+        map.ids.resize(slots);
+        if (!map.heights.empty())
+            map.heights.resize(slots, 0);
+        if (!map.flags.empty())
+            map.flags.resize(slots, TILE_FLAG_NONE);
+    }
+
+    if (size > map.generated)
+    {
+        fillTiles(map, map.generated, size, 0, map.generated, sampler, pool); // right edge of the old rows
+        fillTiles(map, 0, size, map.generated, size, sampler, pool);          // new rows
+        map.generated = size;
+    }
+    map.size = size; // shrinking only narrows the view, the tiles stay for when it grows back
+}
+
+void enableTileHeights(TileMap &map)
+{
+    if (map.heights.empty())
+        map.heights.assign(map.ids.size(), 0);
+}
+
+void enableTileFlags(TileMap &map)
+{
+    if (map.flags.empty())
+        map.flags.assign(map.ids.size(), TILE_FLAG_NONE);
+}
+
+size_t tileMapBytesPerTile(const TileMap &map)
+{
+    return sizeof(TileId) + (map.heights.empty() ? 0 : sizeof(uint16_t)) + (map.flags.empty() ? 0 : sizeof(uint8_t));
+}
+
+size_t tileMapBytes(const TileMap &map)
+{
+    return map.ids.capacity() * sizeof(TileId) + map.heights.capacity() * sizeof(uint16_t) + map.flags.capacity() * sizeof(uint8_t);
+}
+
+size_t tileMapBytesAt(const TileMap &map, int size)
+{
+    return tileMapSlots(size) * tileMapBytesPerTile(map);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "alias_table.hpp"
+#include "definitions.hpp"
+#include "thread_pool.hpp"
+
+// Chance of every tile index when a normal around the middle tile is clamped by rejection to [0, tileCount - 1] and rounded
+std::vector<double> normalTileWeights(int tileCount, float stddev);
+
+typedef uint8_t TileId; // index into the atlas
+static_assert(IMG_ARRAY_SIZE <= 256, "TileId is too small for IMG_ARRAY_SIZE tiles");
+
+// Per-tile bits kept next to the ids
+enum TileFlag : uint8_t
+{
+    TILE_FLAG_NONE = 0,
+    TILE_FLAG_STACKED = 1 << 0, // a voxel column stands on the tile, mirrors VoxelStacks so a lone tile needs no chunk lookup
+};
+
+// Interleaves the low 16 bits of v with zeros: bit i moves to bit 2i
+inline uint32_t spreadBits(uint32_t v)
+{
+    v &= 0xFFFFu;
+    v = (v | (v << 8)) & 0x00FF00FFu;
+    v = (v | (v << 4)) & 0x0F0F0F0Fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+// First slot of chunk (chunkCol, chunkRow): chunks follow the Morton (Z) curve, so neighbours share cache lines and pages
+inline size_t chunkOffset(int chunkCol, int chunkRow)
+{
+    size_t morton = spreadBits(static_cast<uint32_t>(chunkCol)) | (spreadBits(static_cast<uint32_t>(chunkRow)) << 1);
+    return morton << (2 * TILE_CHUNK_SHIFT);
+}
+
+// Slot of a tile: its chunk, then row-major inside the chunk. Independent of the map size, so resizing never moves a tile.
+inline size_t tileSlot(int col, int row)
+{
+    const int mask = TILE_CHUNK_SIZE - 1;
+    return chunkOffset(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT) +
+           static_cast<size_t>(((row & mask) << TILE_CHUNK_SHIFT) | (col & mask));
+}
+
+// One attribute of every tile in the map's chunked layout; data is null when the map does not carry it
+template <typename T>
+struct TileSpan
+{
+    T *data;
+    int size;
+
+    T *chunk(int chunkCol, int chunkRow) const { return data + chunkOffset(chunkCol, chunkRow); } // TILE_CHUNK_SIZE rows of TILE_CHUNK_SIZE tiles
+    T &operator()(int col, int row) const { return data[tileSlot(col, row)]; }
+};
+
+/**
+ * Square map of tiles addressed by (col, row). Tiles are stored in 32x32 chunks laid out along
+ * a Z-order curve (see tileSlot()), so a tile keeps its slot while the map grows and shrinks and
+ * a culled window of a huge map touches few pages. Attributes live in separate dense arrays
+ * (structure of arrays): a pass that only needs ids streams one byte per tile. Heights and flags
+ * are optional and only take memory once enabled. Each id only depends on (seed, col, row): the
+ * map is bit-identical for any thread count, and growing it only has to generate the new border.
+ */
+struct TileMap
+{
+    std::vector<TileId> ids;       // one slot per tile of every chunk up to the last one in Z-order
+    std::vector<uint16_t> heights; // base height in pixels, added to the altitude; empty unless enabled
+    std::vector<uint8_t> flags;    // TileFlag bits; empty unless enabled
+    int size;                      // columns and rows in use
+    int generated;                 // tiles of [0, generated)^2 are valid, may be more than size after a shrink
+    uint64_t seed;
+};
+
+inline int tileAt(const TileMap &map, int col, int row)
+{
+    return map.ids[tileSlot(col, row)];
+}
+
+inline TileSpan<const TileId> tileIds(const TileMap &map) { return {map.ids.data(), map.size}; }
+inline TileSpan<const uint16_t> tileHeights(const TileMap &map) { return {map.heights.empty() ? nullptr : map.heights.data(), map.size}; }
+inline TileSpan<const uint8_t> tileFlags(const TileMap &map) { return {map.flags.empty() ? nullptr : map.flags.data(), map.size}; }
+inline TileSpan<uint16_t> tileHeights(TileMap &map) { return {map.heights.empty() ? nullptr : map.heights.data(), map.size}; }
+inline TileSpan<uint8_t> tileFlags(TileMap &map) { return {map.flags.empty() ? nullptr : map.flags.data(), map.size}; }
+
+inline bool tileHasFlag(const TileMap &map, int col, int row, TileFlag flag)
+{
+    return !map.flags.empty() && (map.flags[tileSlot(col, row)] & flag);
+}
+
+// Fills size * size tiles drawn from `sampler` across `pool`, discarding the previous map (enabled layers are kept, zeroed)
+void generateTileMap(TileMap &map, int size, const AliasTable &sampler, uint64_t seed, ThreadPool &pool);
+// Changes the size keeping every existing tile, only tiles never generated before are drawn (same sampler as the map)
+void resizeTileMap(TileMap &map, int size, const AliasTable &sampler, ThreadPool &pool);
+void enableTileHeights(TileMap &map); // allocates the height layer, all 0
+void enableTileFlags(TileMap &map);   // allocates the flag layer, all TILE_FLAG_NONE
+
+size_t tileMapBytesPerTile(const TileMap &map);       // summed element size of the layers the map carries
+size_t tileMapBytes(const TileMap &map);              // allocated bytes of every layer
+size_t tileMapBytesAt(const TileMap &map, int size); // what a size * size map with the same layers takes
+size_t tileMapSlots(int size);                        // slots of each layer for a size * size map
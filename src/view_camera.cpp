@@ -0,0 +1,60 @@
+#include "view_camera.hpp"
+
+#include <raymath.h>
+
+#include <cmath>
+
+#include "definitions.hpp"
+
+void resetViewCamera(ViewCamera &view, Vector2 target, Vector2 offset)
+{
+    view.camera = {offset, target, 0.f, 1.f};
+    view.goal = target;
+}
+
+void panViewCamera(ViewCamera &view, Vector2 screenDelta)
+{
+    view.goal = Vector2Add(view.goal, Vector2Scale(screenDelta, 1.f / view.camera.zoom));
+}
+
+void zoomViewCamera(ViewCamera &view, float factor, Vector2 screenPoint)
+{
+    Vector2 before = GetScreenToWorld2D(screenPoint, view.camera);
+    view.camera.zoom = Clamp(view.camera.zoom * factor, CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+    Vector2 shift = Vector2Subtract(before, GetScreenToWorld2D(screenPoint, view.camera));
+
+    // zooming is never eased, both the target and where it is heading move with it
+    view.camera.target = Vector2Add(view.camera.target, shift);
+    view.goal = Vector2Add(view.goal, shift);
+}
+
+void updateViewCamera(ViewCamera &view, float frameSeconds)
+{
+    if (!view.smooth)
+    {
+        view.camera.target = view.goal;
+        return;
+    }
+
+    // exponential easing, the same fraction of the remaining distance per second whatever the frame rate
+    float t = 1.f - expf(-CAMERA_FOLLOW_RATE * frameSeconds);
+    view.camera.target = Vector2Lerp(view.camera.target, view.goal, t);
+    if (Vector2Distance(view.camera.target, view.goal) * view.camera.zoom < .1f)
+        view.camera.target = view.goal; // settle, so a still camera lets static scenes be cached
+}
+
+Rectangle viewCameraRect(const ViewCamera &view, int width, int height)
+{
+    // the camera never rotates, so the screen corners map to an axis aligned rectangle
+    Vector2 topLeft = GetScreenToWorld2D({0, 0}, view.camera);
+    Vector2 bottomRight = GetScreenToWorld2D({(float)width, (float)height}, view.camera);
+    return {topLeft.x, topLeft.y, bottomRight.x - topLeft.x, bottomRight.y - topLeft.y};
+}
+
+int tileLod(float zoom, int tileWidth)
+{
+    int lod = 1;
+    while ((float)(tileWidth * lod) * zoom < LOD_MIN_TILE_PIXELS)
+        lod *= 2;
+    return lod;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <raylib.h>
+
+// Camera2D over the tile field plus the target it is heading to, applied with BeginMode2D
+struct ViewCamera
+{
+    Camera2D camera; // target is the point of the tile field shown at offset (the screen centre)
+    Vector2 goal;    // target panning asks for, see updateViewCamera()
+    bool smooth;     // ease the target towards goal instead of jumping to it
+};
+
+void resetViewCamera(ViewCamera &view, Vector2 target, Vector2 offset);      // zoom 1, nothing moving
+void panViewCamera(ViewCamera &view, Vector2 screenDelta);                   // moves goal by a distance in screen pixels
+void zoomViewCamera(ViewCamera &view, float factor, Vector2 screenPoint);    // keeps the point under screenPoint in place
+void updateViewCamera(ViewCamera &view, float frameSeconds);                 // once per frame
+Rectangle viewCameraRect(const ViewCamera &view, int width, int height);     // part of the tile field a width x height screen shows
+int tileLod(float zoom, int tileWidth);                                      // tiles per side of the blocks drawn as one sprite, 1 when zoomed in
@@ -0,0 +1,218 @@
+#include "voxel_stacks.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "random.hpp"
+
+using namespace std;
+
+static uint64_t chunkKey(int chunkCol, int chunkRow)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunkRow)) << 32) | static_cast<uint32_t>(chunkCol);
+}
+
+static uint16_t cellIndex(int col, int row)
+{
+    const int mask = TILE_CHUNK_SIZE - 1;
+    return static_cast<uint16_t>(((row & mask) << TILE_CHUNK_SHIFT) | (col & mask));
+}
+
+static VoxelColumn *findColumn(VoxelStacks &stacks, int col, int row)
+{
+    return const_cast<VoxelColumn *>(voxelColumn(stacks, col, row));
+}
+
+// Solid layers a cell shows its neighbours: its column, or the map tile alone
+static uint32_t cellLayers(const VoxelStacks &stacks, int col, int row)
+{
+    if (col < 0 || row < 0 || col >= stacks.size || row >= stacks.size)
+        return 0;
+    const VoxelColumn *column = voxelColumn(stacks, col, row);
+    return column ? column->solid : 1u;
+}
+
+// The columns behind (col, row) have it as their front neighbour
+static void updateColumnsBehind(VoxelStacks &stacks, int col, int row)
+{
+    uint32_t layers = cellLayers(stacks, col, row);
+    if (VoxelColumn *behindRight = findColumn(stacks, col - 1, row))
+        behindRight->right = layers;
+    if (VoxelColumn *behindLeft = findColumn(stacks, col, row - 1))
+        behindLeft->left = layers;
+}
+
+void clearVoxelStacks(VoxelStacks &stacks, int size)
+{
+    stacks.chunks.clear();
+    stacks.size = size;
+    stacks.maxLayers = 1;
+    stacks.columns = 0;
+}
+
+void resizeVoxelStacks(VoxelStacks &stacks, int size)
+{
+    int lo = min(stacks.size, size), hi = max(stacks.size, size);
+    stacks.size = size;
+    if (lo == hi)
+        return;
+
+    // only neighbours whose larger coordinate is in [lo, hi) appeared or disappeared
+    for (auto &[key, chunk] : stacks.chunks)
+    {
+        int chunkCol = static_cast<int>(static_cast<uint32_t>(key)), chunkRow = static_cast<int>(static_cast<uint32_t>(key >> 32));
+        for (VoxelColumn &column : chunk.columns)
+        {
+            int col = (chunkCol << TILE_CHUNK_SHIFT) + (column.cell & (TILE_CHUNK_SIZE - 1));
+            int row = (chunkRow << TILE_CHUNK_SHIFT) + (column.cell >> TILE_CHUNK_SHIFT);
+            int rightEdge = max(col + 1, row), leftEdge = max(col, row + 1);
+            if (rightEdge >= lo && rightEdge < hi)
+                column.right = cellLayers(stacks, col + 1, row);
+            if (leftEdge >= lo && leftEdge < hi)
+                column.left = cellLayers(stacks, col, row + 1);
+        }
+    }
+}
+
+const VoxelChunk *voxelChunk(const VoxelStacks &stacks, int chunkCol, int chunkRow)
+{
+    if (stacks.chunks.empty())
+        return nullptr;
+    auto found = stacks.chunks.find(chunkKey(chunkCol, chunkRow));
+    return found == stacks.chunks.end() ? nullptr : &found->second;
+}
+
+const VoxelColumn *voxelColumn(const VoxelStacks &stacks, int col, int row)
+{
+    if (col < 0 || row < 0)
+        return nullptr;
+    const VoxelChunk *chunk = voxelChunk(stacks, col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT);
+    return chunk ? chunkColumn(*chunk, col, row) : nullptr;
+}
+
+int voxelHeight(const VoxelStacks &stacks, int col, int row)
+{
+    const VoxelColumn *column = voxelColumn(stacks, col, row);
+    return column ? 32 - __builtin_clz(column->solid) : 1;
+}
+
+void setVoxel(VoxelStacks &stacks, int col, int row, int layer, TileId tile, bool solid)
+{
+    if (col < 0 || row < 0 || layer < 1 || layer >= VOXEL_MAX_LAYERS)
+        return;
+    VoxelColumn *column = findColumn(stacks, col, row);
+    if (!column && !solid)
+        return;
+
+    if (!column)
+    {
+        VoxelChunk &chunk = stacks.chunks[chunkKey(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT)];
+        if (chunk.cells.empty())
+            chunk.cells.assign(TILE_CHUNK_SIZE * TILE_CHUNK_SIZE, 0);
+        VoxelColumn created = {};
+        created.solid = 1u;
+        created.right = cellLayers(stacks, col + 1, row);
+        created.left = cellLayers(stacks, col, row + 1);
+        created.cell = cellIndex(col, row);
+        chunk.columns.push_back(created);
+        chunk.cells[created.cell] = static_cast<uint16_t>(chunk.columns.size());
+        column = &chunk.columns.back();
+        stacks.columns++;
+    }
+
+    uint32_t bit = 1u << layer;
+    column->tiles[layer] = tile;
+    uint32_t layers = solid ? column->solid | bit : column->solid & ~bit;
+    if (layers == column->solid)
+        return;
+    column->solid = layers;
+    column->top = layers & (layers >> 1);
+    stacks.maxLayers = max(stacks.maxLayers, layer + 1);
+    updateColumnsBehind(stacks, col, row);
+
+    if (layers == 1u)
+    {
+        // back to a lone map tile, its slot goes to the chunk's last column
+        VoxelChunk &chunk = stacks.chunks[chunkKey(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT)];
+        uint16_t cell = column->cell;
+        size_t index = chunk.cells[cell] - 1u;
+        chunk.columns[index] = chunk.columns.back();
+        chunk.cells[chunk.columns[index].cell] = static_cast<uint16_t>(index + 1);
+        chunk.cells[cell] = 0;
+        chunk.columns.pop_back();
+        if (chunk.columns.empty())
+            stacks.chunks.erase(chunkKey(col >> TILE_CHUNK_SHIFT, row >> TILE_CHUNK_SHIFT));
+        stacks.columns--;
+    }
+}
+
+void raiseVoxelHills(VoxelStacks &stacks, const TileMap &map, uint64_t seed, int count)
+{
+    if (map.size <= 0)
+        return;
+    for (int hill = 0; hill < count; hill++)
+    {
+        uint64_t bits = hashCoords(seed, static_cast<uint32_t>(hill), 0x68696c6cu); // "hill"
+        int centerCol = static_cast<int>(bits % static_cast<uint64_t>(map.size));
+        int centerRow = static_cast<int>((bits >> 20) % static_cast<uint64_t>(map.size));
+        int radius = 3 + static_cast<int>((bits >> 40) % (VOXEL_HILL_RADIUS - 2));
+        int peak = min(radius, VOXEL_MAX_LAYERS - 1); // at most one layer per tile of slope
+
+        for (int row = max(centerRow - radius, 0); row <= min(centerRow + radius, map.size - 1); row++)
+            for (int col = max(centerCol - radius, 0); col <= min(centerCol + radius, map.size - 1); col++)
+            {
+                float distance = hypotf((float)(col - centerCol), (float)(row - centerRow));
+                int height = 1 + (int)((float)peak * (1.f - distance / (float)radius));
+                TileId tile = static_cast<TileId>(tileAt(map, col, row));
+                for (int layer = voxelHeight(stacks, col, row); layer < height; layer++)
+                    setVoxel(stacks, col, row, layer, tile, true);
+            }
+    }
+}
+
+size_t voxelStacksBytes(const VoxelStacks &stacks)
+{
+    size_t bytes = 0;
+    for (const auto &[key, chunk] : stacks.chunks)
+        bytes += sizeof(key) + sizeof(chunk) + chunk.cells.capacity() * sizeof(uint16_t) + chunk.columns.capacity() * sizeof(VoxelColumn);
+    return bytes;
+}
+
+void markStackedTiles(const VoxelStacks &stacks, TileMap &map)
+{
+    if (stacks.columns == 0 && map.flags.empty())
+        return; // never stacked, the flags need not exist
+    enableTileFlags(map);
+    for (uint8_t &flags : map.flags)
+        flags &= (uint8_t)~TILE_FLAG_STACKED;
+    for (const auto &[key, chunk] : stacks.chunks)
+    {
+        int chunkCol = static_cast<int>(static_cast<uint32_t>(key)), chunkRow = static_cast<int>(static_cast<uint32_t>(key >> 32));
+        size_t first = chunkOffset(chunkCol, chunkRow);
+        if (first >= map.flags.size())
+            continue;
+        for (const VoxelColumn &column : chunk.columns)
+            map.flags[first + column.cell] |= TILE_FLAG_STACKED; // cells are row-major in the chunk, as slots are
+    }
+}
+
+// Layers of a neighbour's side that stay covered when it is `delta` pixels higher: its layers move
+// by delta / layerHeight against this column's, every layer the face overlaps must be solid
+static uint32_t coveredLayers(uint32_t neighbour, float delta, float layerHeight)
+{
+    int offset = (int)ceilf(fabsf(delta) / layerHeight);
+    if (offset >= VOXEL_MAX_LAYERS)
+        return 0;
+    uint32_t covered = neighbour;
+    for (int i = 1; i <= offset; i++)
+        covered &= delta > 0.f ? neighbour << i : neighbour >> i;
+    return covered;
+}
+
+uint32_t visibleVoxelLayers(const VoxelColumn &column, float altitude, float rightAltitude, float leftAltitude, float layerHeight)
+{
+    // the layer above moves with the column, so the top mask holds at any altitude
+    uint32_t hidden = column.top & coveredLayers(column.right, rightAltitude - altitude, layerHeight) &
+                      coveredLayers(column.left, leftAltitude - altitude, layerHeight);
+    return column.solid & ~hidden;
+}
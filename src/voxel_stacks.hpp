@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+#include "tile_map.hpp"
+
+static_assert(VOXEL_MAX_LAYERS <= 32, "VoxelColumn masks hold one bit per layer");
+
+/**
+ * Tiles stacked on one cell of the map. Layer 0 is the map tile itself, each layer above is drawn
+ * VOXEL_LAYER_HEIGHT of a tile height higher. A layer is completely hidden once the layer above it
+ * covers its top face and the two front neighbours cover its side faces, the masks record which
+ * layers those are.
+ */
+struct VoxelColumn
+{
+    uint32_t solid; // bit k: layer k holds a tile, bit 0 (the map tile) is always set
+    uint32_t top;   // bit k: layer k + 1 is solid and covers the top face of layer k
+    uint32_t right; // solid layers of the neighbour at (col + 1, row), in front of the lower right face
+    uint32_t left;  // solid layers of the neighbour at (col, row + 1), in front of the lower left face
+    uint16_t cell;  // row-major index in its chunk
+    TileId tiles[VOXEL_MAX_LAYERS]; // tile of every solid layer but 0, which is read from the map
+};
+
+// Columns of one 32x32 chunk of the map
+struct VoxelChunk
+{
+    std::vector<uint16_t> cells; // row-major, index + 1 of the cell's column, 0 for a lone map tile
+    std::vector<VoxelColumn> columns;
+};
+
+/**
+ * Sparse stacks on the tile map: only chunks holding a column take memory and a lone map tile costs
+ * nothing. The occlusion masks are updated when a column changes, for it and the two columns behind
+ * it (whose front neighbour it is), so drawing only has to combine them.
+ */
+struct VoxelStacks
+{
+    std::unordered_map<uint64_t, VoxelChunk> chunks; // by packed chunk (col, row)
+    int size;      // map size the side masks were computed for, cells past it have no layers
+    int maxLayers; // bound on the layers of any column, for culling and picking
+    size_t columns;
+};
+
+void clearVoxelStacks(VoxelStacks &stacks, int size);
+void resizeVoxelStacks(VoxelStacks &stacks, int size); // updates the side masks of columns whose neighbours crossed the map edge
+const VoxelChunk *voxelChunk(const VoxelStacks &stacks, int chunkCol, int chunkRow); // null when the chunk holds no column
+const VoxelColumn *voxelColumn(const VoxelStacks &stacks, int col, int row);         // null for a lone map tile
+int voxelHeight(const VoxelStacks &stacks, int col, int row);                         // layers up to the highest solid one, 1 for a lone map tile
+void setVoxel(VoxelStacks &stacks, int col, int row, int layer, TileId tile, bool solid); // layers 1 and up, 0 is the map tile
+void raiseVoxelHills(VoxelStacks &stacks, const TileMap &map, uint64_t seed, int count); // cones of the map tile, taller columns are kept
+size_t voxelStacksBytes(const VoxelStacks &stacks);
+void markStackedTiles(const VoxelStacks &stacks, TileMap &map); // TILE_FLAG_STACKED on exactly the tiles holding a column, after the stacks changed
+
+// Layers of a column that may show at these altitudes (pixels, the column's and its front neighbours')
+uint32_t visibleVoxelLayers(const VoxelColumn &column, float altitude, float rightAltitude, float leftAltitude, float layerHeight);
+
+inline const VoxelColumn *chunkColumn(const VoxelChunk &chunk, int col, int row)
+{
+    const int mask = TILE_CHUNK_SIZE - 1;
+    uint16_t index = chunk.cells[static_cast<size_t>(((row & mask) << TILE_CHUNK_SHIFT) | (col & mask))];
+    return index ? &chunk.columns[index - 1u] : nullptr;
+}
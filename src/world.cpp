@@ -0,0 +1,155 @@
+#include "world.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "definitions.hpp"
+#include "random.hpp"
+
+using namespace std;
+
+static uint64_t chunkKey(int chunkCol, int chunkRow)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunkRow)) << 32) | static_cast<uint32_t>(chunkCol);
+}
+
+void initWorld(World &world, size_t budgetBytes)
+{
+    world.budgetBytes = budgetBytes;
+    world.mailbox = make_shared<WorldMailbox>();
+    world.generators = make_unique<ThreadPool>(WORLD_GENERATOR_THREADS + 1); // +1: the pool counts the caller, which never helps here
+    world.generation = 0;
+    world.pending = 0;
+    world.frame = 0;
+}
+
+void unloadWorld(World &world)
+{
+    world.generators.reset(); // joins the generator threads after their queue drains
+    world.chunks.clear();
+    world.lru.clear();
+    world.mailbox.reset();
+}
+
+void resetWorld(World &world, uint64_t seed, const AliasTable &sampler)
+{
+    world.seed = seed;
+    world.sampler = sampler;
+    world.chunks.clear();
+    world.lru.clear();
+    world.generation++;
+    world.pending = 0;
+}
+
+void beginWorldFrame(World &world)
+{
+    world.frame++;
+    world.viewMin[0] = world.viewMin[1] = INT32_MAX;
+    world.viewMax[0] = world.viewMax[1] = INT32_MIN;
+
+    vector<pair<uint64_t, unique_ptr<WorldChunk>>> done;
+    vector<unsigned int> generations;
+    {
+        lock_guard<mutex> lock(world.mailbox->mutex);
+        done.swap(world.mailbox->done);
+        generations.swap(world.mailbox->generations);
+    }
+
+    for (size_t i = 0; i < done.size(); i++)
+    {
+        if (generations[i] != world.generation)
+            continue; // requested before the last reset
+        world.pending--;
+        auto found = world.chunks.find(done[i].first);
+        if (found == world.chunks.end())
+            continue;
+        found->second.chunk = std::move(done[i].second);
+        world.lru.push_front(done[i].first);
+        found->second.lru = world.lru.begin();
+    }
+}
+
+// Queues generation of a chunk unless it is known already or the queue is full
+static void requestChunk(World &world, int chunkCol, int chunkRow)
+{
+    uint64_t key = chunkKey(chunkCol, chunkRow);
+    if (world.pending >= WORLD_MAX_PENDING || world.chunks.count(key))
+        return;
+
+    world.chunks[key].lastFrame = world.frame;
+    world.pending++;
+
+    shared_ptr<WorldMailbox> mailbox = world.mailbox;
+    uint64_t seed = world.seed;
+    AliasTable sampler = world.sampler;
+    unsigned int generation = world.generation;
+    world.generators->submit([=]
+                             {
+                                 auto chunk = make_unique<WorldChunk>();
+                                 const int mask = TILE_CHUNK_SIZE - 1;
+                                 for (int i = 0; i < TILE_CHUNK_SIZE * TILE_CHUNK_SIZE; i++)
+                                 {
+                                     int col = (chunkCol << TILE_CHUNK_SHIFT) + (i & mask);
+                                     int row = (chunkRow << TILE_CHUNK_SHIFT) + (i >> TILE_CHUNK_SHIFT);
+                                     chunk->ids[i] = (TileId)sampleAlias(sampler, hashCoords(seed, static_cast<uint32_t>(col), static_cast<uint32_t>(row)));
+                                 }
+                                 lock_guard<mutex> lock(mailbox->mutex);
+                                 mailbox->done.emplace_back(key, std::move(chunk));
+                                 mailbox->generations.push_back(generation); });
+}
+
+const TileId *worldChunk(World &world, int chunkCol, int chunkRow)
+{
+    world.viewMin[0] = min(world.viewMin[0], chunkCol);
+    world.viewMin[1] = min(world.viewMin[1], chunkRow);
+    world.viewMax[0] = max(world.viewMax[0], chunkCol);
+    world.viewMax[1] = max(world.viewMax[1], chunkRow);
+
+    auto found = world.chunks.find(chunkKey(chunkCol, chunkRow));
+    if (found == world.chunks.end())
+    {
+        requestChunk(world, chunkCol, chunkRow);
+        return nullptr;
+    }
+
+    WorldEntry &entry = found->second;
+    entry.lastFrame = world.frame;
+    if (!entry.chunk)
+        return nullptr;
+    world.lru.splice(world.lru.begin(), world.lru, entry.lru); // most recently used
+    return entry.chunk->ids;
+}
+
+void endWorldFrame(World &world, float motionCols, float motionRows)
+{
+    // the view rectangle moved ahead by WORLD_PREFETCH_CHUNKS along each axis the camera travels in
+    if (world.viewMin[0] <= world.viewMax[0] && (motionCols != 0.f || motionRows != 0.f))
+    {
+        int stepCol = motionCols > 0.f ? 1 : (motionCols < 0.f ? -1 : 0);
+        int stepRow = motionRows > 0.f ? 1 : (motionRows < 0.f ? -1 : 0);
+        for (int ahead = 1; ahead <= WORLD_PREFETCH_CHUNKS; ahead++)
+        {
+            int colBegin = world.viewMin[0] + stepCol * ahead, colEnd = world.viewMax[0] + stepCol * ahead;
+            int rowBegin = world.viewMin[1] + stepRow * ahead, rowEnd = world.viewMax[1] + stepRow * ahead;
+            for (int row = rowBegin; row <= rowEnd; row++)
+                for (int col = colBegin; col <= colEnd; col++)
+                    requestChunk(world, col, row);
+        }
+    }
+
+    // least recently used first, never what this frame still looked at
+    size_t chunkBytes = sizeof(WorldChunk);
+    while (!world.lru.empty() && world.lru.size() * chunkBytes > world.budgetBytes)
+    {
+        auto found = world.chunks.find(world.lru.back());
+        if (found->second.lastFrame == world.frame)
+            break;
+        world.chunks.erase(found);
+        world.lru.pop_back();
+    }
+}
+
+size_t worldBytes(const World &world)
+{
+    return world.lru.size() * sizeof(WorldChunk);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "alias_table.hpp"
+#include "thread_pool.hpp"
+#include "tile_map.hpp"
+
+// One chunk of the unbounded world, same row-major 32x32 layout as a TileMap chunk
+struct WorldChunk
+{
+    TileId ids[TILE_CHUNK_SIZE * TILE_CHUNK_SIZE];
+};
+
+// Chunks finished by the generator threads, collected by the next beginWorldFrame()
+struct WorldMailbox
+{
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, std::unique_ptr<WorldChunk>>> done;
+    std::vector<unsigned int> generations; // generation each entry of `done` was requested in
+};
+
+struct WorldEntry
+{
+    std::unique_ptr<WorldChunk> chunk; // null while it is being generated
+    std::list<uint64_t>::iterator lru; // position in World::lru once ready
+    uint64_t lastFrame;                // frame it was last looked up in
+};
+
+/**
+ * Unbounded tile map generated chunk by chunk on background threads. Tiles come from the same
+ * hash of (seed, col, row) and alias table as TileMap, so inside [0, gridSize) the world is the
+ * bounded map. Lookups never wait: a chunk that is not ready returns null (drawn as a placeholder)
+ * and gets queued. Ready chunks are kept in LRU order and the least recently used ones are dropped
+ * once they exceed the memory budget; chunks ahead of the camera motion are requested early.
+ */
+struct World
+{
+    uint64_t seed;
+    AliasTable sampler;
+    std::unordered_map<uint64_t, WorldEntry> chunks; // ready and pending chunks by packed coordinates
+    std::list<uint64_t> lru;                          // ready chunks, most recently used first
+    std::shared_ptr<WorldMailbox> mailbox;            // shared with running jobs, which may outlive a reset
+    std::unique_ptr<ThreadPool> generators;
+    size_t budgetBytes;
+    unsigned int generation; // bumped by resetWorld(), late chunks of older generations are dropped
+    int pending;             // chunks queued or being generated
+    uint64_t frame;
+    int viewMin[2];          // chunk bounds looked up this frame (col, row), what prefetching extends
+    int viewMax[2];
+};
+
+void initWorld(World &world, size_t budgetBytes);
+void unloadWorld(World &world);
+void resetWorld(World &world, uint64_t seed, const AliasTable &sampler); // drops every chunk, new tiles from now on
+void beginWorldFrame(World &world);                                         // takes in finished chunks
+const TileId *worldChunk(World &world, int chunkCol, int chunkRow);         // null until generated
+void endWorldFrame(World &world, float motionCols, float motionRows);      // prefetches along the motion (tiles per frame), evicts past the budget
+size_t worldBytes(const World &world);                                      // memory of the ready chunks